@@ -0,0 +1,119 @@
+/*
+ * File: arena.c
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Bump allocator whose allocations are all released at once.
+ */
+
+#include "arena.h"
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN alignof(max_align_t)
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+struct ArenaChunk {
+    ArenaChunk* prev;
+    size_t size;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+static size_t align_up(size_t n)
+{
+    return (n + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+void arena_init(Arena* arena, size_t chunkSize)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->chunkSize = chunkSize ? chunkSize : ARENA_DEFAULT_CHUNK;
+}
+
+static ArenaChunk* arena_new_chunk(Arena* arena, size_t minSize)
+{
+    size_t size = arena->chunkSize ? arena->chunkSize : ARENA_DEFAULT_CHUNK;
+    if (size < minSize)
+        size = minSize;
+    ArenaChunk* chunk = malloc(sizeof(ArenaChunk) + size);
+    if (!chunk)
+        return NULL;
+    chunk->prev = arena->head;
+    chunk->size = size;
+    chunk->used = 0;
+    arena->head = chunk;
+    arena->bytesReserved += size;
+    arena->chunkCount++;
+    return chunk;
+}
+
+void* arena_alloc(Arena* arena, size_t size)
+{
+    if (!arena)
+        return NULL;
+    size_t need = align_up(size ? size : 1);
+    ArenaChunk* chunk = arena->head;
+    if (!chunk || chunk->size - chunk->used < need) {
+        chunk = arena_new_chunk(arena, need);
+        if (!chunk)
+            return NULL;
+    }
+    void* ptr = chunk->data + chunk->used;
+    chunk->used += need;
+    arena->bytesUsed += need;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void* arena_grow(Arena* arena, void* ptr, size_t oldSize, size_t newSize)
+{
+    if (!ptr)
+        return arena_alloc(arena, newSize);
+    if (newSize <= oldSize)
+        return ptr;
+
+    ArenaChunk* chunk = arena->head;
+    size_t oldNeed = align_up(oldSize ? oldSize : 1);
+    size_t newNeed = align_up(newSize);
+    if (chunk && (unsigned char*)ptr + oldNeed == chunk->data + chunk->used &&
+        chunk->size - chunk->used >= newNeed - oldNeed) {
+        // Latest allocation: extend in place
+        chunk->used += newNeed - oldNeed;
+        arena->bytesUsed += newNeed - oldNeed;
+        memset((unsigned char*)ptr + oldSize, 0, newSize - oldSize);
+        return ptr;
+    }
+
+    void* grown = arena_alloc(arena, newSize);
+    if (grown)
+        memcpy(grown, ptr, oldSize);
+    return grown;
+}
+
+void arena_release(Arena* arena)
+{
+    if (!arena)
+        return;
+    ArenaChunk* chunk = arena->head;
+    while (chunk) {
+        ArenaChunk* prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+    size_t chunkSize = arena->chunkSize;
+    memset(arena, 0, sizeof(*arena));
+    arena->chunkSize = chunkSize;
+}
+
+void* arena_array_reserve(Arena* arena, void* items, size_t count, size_t* capacity, size_t itemSize)
+{
+    if (count < *capacity)
+        return items;
+    size_t newCap = *capacity ? *capacity * 2 : 16;
+    void* grown = arena_grow(arena, items, *capacity * itemSize, newCap * itemSize);
+    if (grown)
+        *capacity = newCap;
+    return grown;
+}
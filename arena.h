@@ -0,0 +1,36 @@
+#pragma once
+
+/*
+ * File: arena.h
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Bump allocator whose allocations are all released at once.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    ArenaChunk* head;      // chunk currently bumped into
+    size_t chunkSize;      // default size of new chunks
+    size_t bytesUsed;      // payload handed out, including alignment padding
+    size_t bytesReserved;  // chunk memory obtained from malloc
+    size_t chunkCount;
+} Arena;
+
+void arena_init(Arena* arena, size_t chunkSize);
+/* Zeroed memory aligned for any type; NULL when out of memory. */
+void* arena_alloc(Arena* arena, size_t size);
+/* Resize the latest allocation in place when possible, otherwise copy. */
+void* arena_grow(Arena* arena, void* ptr, size_t oldSize, size_t newSize);
+/* Free every chunk; the arena can be reused afterwards. */
+void arena_release(Arena* arena);
+
+/*
+ * Make room for one more item in an arena-backed array, doubling its
+ * capacity when needed. Returns the (possibly moved) array with the new
+ * slots zeroed, or NULL when out of memory.
+ */
+void* arena_array_reserve(Arena* arena, void* items, size_t count, size_t* capacity, size_t itemSize);
@@ -6,75 +6,98 @@
  */
 
 #include "icd_parser.h"
+#include "str_index.h"
+#include "arena.h"
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <string.h>
+#include <strings.h>
+#include <ctype.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #include "iec61850_common.h"
 
+/*
+ * Interned SCL identifier: position + 1 in IcdDocument.symbols. Every
+ * distinct string is stored once and entries compare by id.
+ */
+typedef uint32_t Sym;
+#define SYM_EMPTY 0u            // "" and missing attributes
+#define SYM_NONE UINT32_MAX     // lookup of a string that was never interned
+
 typedef struct DOEntry {
-    char lnType[64];
-    char lnClass[32];
-    char doName[64];
-    char doType[64];
-    char cdc[16];
-    struct DOEntry* next;
+    Sym lnType;
+    Sym lnClass;
+    Sym doName;
+    Sym doType;
+    Sym cdc;
+    uint8_t cdcCode;    // IcdCdc
 } DOEntry;
 
 typedef struct DAEntry {
-    char doType[64];
-    char daPath[128];  // Example: "Oper.ctlVal" or just "stVal"
-    char fc[8];
-    char bType[32];
-    char typeId[64];
+    Sym daPath;   // Example: "Oper.ctlVal" or just "stVal"
+    Sym fc;
+    Sym bType;
+    Sym typeId;
     uint8_t trgOps;
-    struct DAEntry* next;
+    uint8_t bTypeCode;  // IcdBType
+    uint8_t fcCode;     // IcdFc
 } DAEntry;
 
+/* All DAs of one DOType, contiguous and in insertion order */
+typedef struct {
+    Sym doType;
+    DAEntry* items;
+    size_t count;
+    size_t capacity;
+} DaTypeTable;
+
 typedef struct LNEntry {
-    char name[64];
-    char lnClass[16];
-    struct LNEntry* next;
+    Sym name;
+    Sym lnClass;
 } LNEntry;
 
 
 typedef struct LNInstEntry {
-    char ldInst[64];
-    char prefix[64];
-    char lnClass[16];
-    char lnInst[16];
-    char lnType[64];
-    char lnName[64];
+    Sym ldInst;
+    Sym prefix;
+    Sym lnClass;
+    Sym lnInst;
+    Sym lnType;
+    Sym lnName;
     int isLn0;
-    struct LNInstEntry* next;
 } LNInstEntry;
 typedef struct FcdaEntry {
-    char ldInst[64];
-    char prefix[64];
-    char lnClass[16];
-    char lnInst[16];
-    char doName[64];
-    char daName[64];
-    char fc[8];
-    struct FcdaEntry* next;
+    Sym ldInst;
+    Sym prefix;
+    Sym lnClass;
+    Sym lnInst;
+    Sym doName;
+    Sym daName;
+    Sym fc;
 } FcdaEntry;
 
 typedef struct DataSetEntryDef {
-    char ldInst[64];
-    char lnName[64];
-    char name[96];
-    FcdaEntry* members;
-    struct DataSetEntryDef* next;
+    Sym ldInst;
+    Sym lnName;
+    Sym name;
+    size_t firstMember;   // members are contiguous in fcda_table
+    size_t memberCount;
 } DataSetEntryDef;
 
 typedef struct ReportEntry {
-    char ldInst[64];
-    char lnName[64];
-    char name[64];
-    char dataSet[96];
-    char rptId[128];
+    Sym ldInst;
+    Sym lnName;
+    Sym name;
+    Sym dataSet;
+    Sym rptId;
     uint32_t confRev;
     uint32_t intgPd;
     uint32_t bufTime;
@@ -82,52 +105,277 @@ typedef struct ReportEntry {
     uint8_t trgOps;
     uint8_t optFields;
     int buffered;
-    struct ReportEntry* next;
 } ReportEntry;
 
-static DOEntry* do_list = NULL;
-static DAEntry* da_list = NULL;
-static LNEntry* ln_list = NULL;
-static LNInstEntry* ln_instances = NULL;
-static DataSetEntryDef* dataset_list = NULL;
-static ReportEntry* report_list = NULL;
-static char selected_ied_name[64] = "";
-static char selected_ap_name[64] = "";
+typedef enum {
+    TEMPLATE_LNODETYPE,
+    TEMPLATE_DOTYPE,
+    TEMPLATE_DATYPE,
+    TEMPLATE_ENUMTYPE,
+    TEMPLATE_KIND_COUNT
+} TemplateKind;
+
+typedef struct {
+    StrIndex ids[TEMPLATE_KIND_COUNT];  // id -> position in nodes
+    xmlNode** nodes;
+    bool* reached;    // per node: resolved at least once during expansion
+    size_t count;
+    size_t capacity;
+} TemplateIndex;
+
+/* One flattened BDA of a DAType subtree, relative to the DA that references the type */
+typedef struct {
+    Sym relPath;
+    Sym fc;            // SYM_EMPTY = inherited from the referencing DA
+    Sym bType;
+    Sym typeId;
+    uint8_t trgOps;
+    bool hasTrgOps;    // false = inherited from the referencing DA
+} DaTypeCacheEntry;
+
+enum { DATYPE_BUILDING, DATYPE_BUILT };
+
+typedef struct {
+    DaTypeCacheEntry* items;  // pre-order, same order as a recursive walk
+    size_t count;
+    size_t capacity;
+    int state;
+} DaTypeExpansion;
+
+/* Tables of one IED and the AccessPoint it was collected from */
+typedef struct {
+    char name[64];
+    char accessPoint[64];
+    LNEntry* ln_table;
+    size_t ln_count;
+    size_t ln_capacity;
+    StrIndex ln_name_index;   // LN name -> position in ln_table
+    LNInstEntry* ln_inst_table;
+    size_t ln_inst_count;
+    size_t ln_inst_capacity;
+    StrIndex ln_inst_name_index;    // ldInst + lnName -> first position in ln_inst_table
+    StrIndex ln_inst_parts_index;   // ldInst + prefix + lnClass + lnInst -> first position in ln_inst_table
+    DataSetEntryDef* dataset_table;
+    size_t dataset_count;
+    size_t dataset_capacity;
+    StrIndex dataset_index;         // ldInst + lnName + dsName -> position in dataset_table
+    FcdaEntry* fcda_table;
+    size_t fcda_count;
+    size_t fcda_capacity;
+    ReportEntry* report_table;
+    size_t report_count;
+    size_t report_capacity;
+} IedTables;
+
+/*
+ * Everything one load produces. Parser tables are arena-backed arrays in
+ * document order; template tables and IED tables use separate arenas so a
+ * streaming retry can drop the IED side alone. Documents share no state,
+ * so separate loads may run on separate threads. DataTypeTemplates are
+ * expanded once and shared by every IED of the document.
+ */
+struct IcdDocument {
+    Arena template_arena;
+    Arena ied_arena;
+    StrIndex symbols;         // interned identifiers, see Sym
+
+    DOEntry* do_table;
+    size_t do_count;
+    size_t do_capacity;
+    DaTypeTable* da_tables;
+    size_t da_table_count;
+    size_t da_table_capacity;
+    StrIndex da_type_index;   // doType -> position in da_tables
+    StrIndex da_path_index;   // doType + daPath -> position in DaTypeTable.items
+
+    IedTables* ieds;          // in file order
+    size_t ied_count;
+    size_t ied_capacity;
+    StrIndex ied_index;       // IED name -> position in ieds
+    size_t cur_ied;           // IED being collected
+    size_t default_ied;       // IED answered for a NULL/empty IED name
+    bool all_ieds;            // index every IED instead of the selected one
+
+    char selected_ied_name[64];
+    char selected_ap_name[64];
+    IcdParseStats parse_stats;
+
+    // Parse-time only, released once the templates are expanded
+    TemplateIndex template_index;
+    DaTypeExpansion* da_type_cache;
+    size_t da_type_cache_count;
+    size_t da_type_cache_capacity;
+    StrIndex da_type_cache_index;   // DAType id -> position in da_type_cache
+    StrIndex expanded_do_types;     // doType + prefix already expanded
+
+    // Attribute values that could not be borrowed from the tree, released after the load
+    Arena scratch_arena;
+
+    // Binary cache the tables point into after a warm start
+    void* model_cache_map;
+    size_t model_cache_size;
+};
+
+/* ---------- Symbols ---------- */
+
+static Sym sym_intern(IcdDocument* doc, const char* str)
+{
+    if (!str || !*str)
+        return SYM_EMPTY;
+    uint32_t pos = str_index_intern(&doc->symbols, str);
+    return pos == UINT32_MAX ? SYM_EMPTY : pos + 1;
+}
+
+static Sym sym_find(const IcdDocument* doc, const char* str)
+{
+    if (!str || !*str)
+        return SYM_EMPTY;
+    uint32_t pos;
+    return str_index_find(&doc->symbols, str, &pos) ? pos + 1 : SYM_NONE;
+}
+
+/* "" for unknown ids. Only valid until the next sym_intern. */
+static const char* sym_str(const IcdDocument* doc, Sym sym)
+{
+    const char* str = sym != SYM_EMPTY ? str_index_key_at(&doc->symbols, sym - 1) : NULL;
+    return str ? str : "";
+}
+
+/* Joined strings of any length: in buf when they fit, otherwise on the heap */
+typedef struct {
+    char* str;            // NULL on OOM
+    char buf[256];
+} JoinBuf;
+
+static const char* join2(JoinBuf* j, const char* a, char sep, const char* b)
+{
+    size_t la = strlen(a), lb = strlen(b);
+    j->str = la + lb + 2 <= sizeof(j->buf) ? j->buf : malloc(la + lb + 2);
+    if (!j->str)
+        return NULL;
+    memcpy(j->str, a, la);
+    j->str[la] = sep;
+    memcpy(j->str + la + 1, b, lb + 1);
+    return j->str;
+}
+
+static void join_free(JoinBuf* j)
+{
+    if (j->str != j->buf)
+        free(j->str);
+}
+
+/* Index key for a pair of symbols */
+static const char* sym_key2(char buf[24], Sym a, Sym b)
+{
+    snprintf(buf, 24, "%x.%x", a, b);
+    return buf;
+}
 
-static void set_selected_ied(const char* name)
+static void set_selected_ied(IcdDocument* doc, const char* name)
 {
     if (!name || !*name)
         return;
-    if (selected_ied_name[0] == '\0') {
-        snprintf(selected_ied_name, sizeof(selected_ied_name), "%s", name);
-        selected_ap_name[0] = '\0';
+    if (doc->selected_ied_name[0] == '\0') {
+        snprintf(doc->selected_ied_name, sizeof(doc->selected_ied_name), "%s", name);
+        doc->selected_ap_name[0] = '\0';
     }
 }
 
-static void set_selected_ap(const char* name)
+static void set_selected_ap(IcdDocument* doc, const char* name)
 {
     if (!name || !*name)
         return;
-    if (selected_ap_name[0] == '\0')
-        snprintf(selected_ap_name, sizeof(selected_ap_name), "%s", name);
+    if (doc->selected_ap_name[0] == '\0')
+        snprintf(doc->selected_ap_name, sizeof(doc->selected_ap_name), "%s", name);
+}
+
+const char* icd_get_selected_ied_name(const IcdDocument* doc)
+{
+    return doc->selected_ied_name;
+}
+
+size_t icd_ied_count(const IcdDocument* doc)
+{
+    return doc ? doc->ied_count : 0;
+}
+
+const char* icd_ied_name(const IcdDocument* doc, size_t index)
+{
+    return doc && index < doc->ied_count ? doc->ieds[index].name : NULL;
+}
+
+
+/* ---------- Attribute access ---------- */
+
+/*
+ * Attribute values are read in place instead of through xmlGetProp, which
+ * returns a fresh copy per call. A borrowed value lives as long as its
+ * element; the rare value split over several nodes (entity references) is
+ * rebuilt once into the scratch arena.
+ */
+static const char* xml_attr_value(IcdDocument* doc, const xmlAttr* attr)
+{
+    const xmlNode* text = attr->children;
+    if (!text)
+        return "";
+    if (text->type == XML_TEXT_NODE && !text->next)
+        return (const char*)text->content;
+
+    xmlChar* value = xmlNodeListGetString(attr->doc, attr->children, 1);
+    if (!value)
+        return "";
+    size_t len = strlen((const char*)value) + 1;
+    char* copy = arena_alloc(&doc->scratch_arena, len);
+    if (copy)
+        memcpy(copy, value, len);
+    xmlFree(value);
+    doc->parse_stats.attrCopies++;
+    return copy;
+}
+
+/* One walk over the element's properties: values[i] = attribute names[i], or NULL if absent */
+static void xml_attrs(IcdDocument* doc, const xmlNode* node, const char* const* names, const char** values,
+                      size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        values[i] = NULL;
+    doc->parse_stats.attrReads += count;
+
+    for (const xmlAttr* a = node->properties; a; a = a->next) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!values[i] && strcmp((const char*)a->name, names[i]) == 0) {
+                values[i] = xml_attr_value(doc, a);
+                break;
+            }
+        }
+    }
 }
 
-const char* icd_get_selected_ied_name(void)
+static const char* xml_attr(IcdDocument* doc, const xmlNode* node, const char* name)
 {
-    return selected_ied_name;
+    const char* value;
+    xml_attrs(doc, node, &name, &value, 1);
+    return value;
 }
 
+enum { DA_NAME, DA_FC, DA_BTYPE, DA_TYPE, DA_DCHG, DA_QCHG, DA_DUPD, DA_ATTR_COUNT };
+static const char* const da_attr_names[DA_ATTR_COUNT] = {
+    "name", "fc", "bType", "type", "dchg", "qchg", "dupd"
+};
+
+static const char* const name_type_attr_names[2] = { "name", "type" };
 
-static xmlNode* find_node(xmlNode* root, const char* name, const char* attr, const char* value) {
+enum { LN_PREFIX, LN_CLASS, LN_INST, LN_TYPE, LN_ATTR_COUNT };
+static const char* const ln_attr_names[LN_ATTR_COUNT] = { "prefix", "lnClass", "inst", "lnType" };
+
+static xmlNode* find_node(IcdDocument* doc, xmlNode* root, const char* name, const char* attr, const char* value) {
     for (xmlNode* node = root; node; node = node->next) {
         if (node->type == XML_ELEMENT_NODE && !xmlStrcmp(node->name, (const xmlChar*)name)) {
             if (attr && value) {
-                xmlChar* val = xmlGetProp(node, (const xmlChar*)attr);
-                if (val && !xmlStrcmp(val, (const xmlChar*)value)) {
-                    xmlFree(val);
+                const char* val = xml_attr(doc, node, attr);
+                if (val && !strcmp(val, value))
                     return node;
-                }
-                if (val) xmlFree(val);
             } else {
                 return node;
             }
@@ -136,91 +384,415 @@ static xmlNode* find_node(xmlNode* root, const char* name, const char* attr, con
     return NULL;
 }
 
-static bool da_entry_exists(const char* doType, const char* daPath) {
-    for (DAEntry* e = da_list; e; e = e->next) {
-        if (!strcmp(e->doType, doType) && !strcmp(e->daPath, daPath))
-            return true;
+static const char* const template_kind_names[TEMPLATE_KIND_COUNT] = {
+    "LNodeType", "DOType", "DAType", "EnumType"
+};
+
+static void template_index_free(IcdDocument* doc)
+{
+    for (int k = 0; k < TEMPLATE_KIND_COUNT; ++k)
+        str_index_free(&doc->template_index.ids[k]);
+    free(doc->template_index.nodes);
+    free(doc->template_index.reached);
+    memset(&doc->template_index, 0, sizeof(doc->template_index));
+}
+
+static bool template_index_add(IcdDocument* doc, TemplateKind kind, xmlNode* node)
+{
+    const char* id = xml_attr(doc, node, "id");
+    if (!id)
+        return false;
+
+    if (doc->template_index.count == doc->template_index.capacity) {
+        size_t newCap = doc->template_index.capacity ? doc->template_index.capacity * 2 : 256;
+        xmlNode** nodes = realloc(doc->template_index.nodes, newCap * sizeof(xmlNode*));
+        if (!nodes)
+            return false;
+        doc->template_index.nodes = nodes;
+        doc->template_index.capacity = newCap;
     }
-    return false;
+
+    // Duplicate ids keep the first definition, as the old linear search did
+    bool added = str_index_insert(&doc->template_index.ids[kind], id, (uint32_t)doc->template_index.count);
+    if (added)
+        doc->template_index.nodes[doc->template_index.count++] = node;
+    return added;
+}
+
+/* One pass over DataTypeTemplates: id -> xmlNode for every type definition */
+static void build_template_index(IcdDocument* doc, xmlNode* templates)
+{
+    template_index_free(doc);
+    for (int k = 0; k < TEMPLATE_KIND_COUNT; ++k)
+        str_index_init(&doc->template_index.ids[k], 64);
+
+    for (xmlNode* node = templates->children; node; node = node->next) {
+        if (node->type != XML_ELEMENT_NODE)
+            continue;
+        for (int k = 0; k < TEMPLATE_KIND_COUNT; ++k) {
+            if (xmlStrcmp(node->name, (const xmlChar*)template_kind_names[k]) == 0) {
+                template_index_add(doc, (TemplateKind)k, node);
+                break;
+            }
+        }
+    }
+    doc->template_index.reached = calloc(doc->template_index.count ? doc->template_index.count : 1, sizeof(bool));
+    doc->parse_stats.templateCount = doc->template_index.count;
+}
+
+static size_t count_unreached_templates(const IcdDocument* doc, TemplateKind kind)
+{
+    const StrIndex* ids = &doc->template_index.ids[kind];
+    if (!doc->template_index.reached)
+        return 0;
+    size_t unreached = 0;
+    for (size_t i = 0; i < ids->count; ++i)
+        if (!doc->template_index.reached[ids->entries[i].value])
+            unreached++;
+    return unreached;
+}
+
+static xmlNode* find_template(IcdDocument* doc, TemplateKind kind, const char* id)
+{
+    if (!id)
+        return NULL;
+    doc->parse_stats.templateLookups++;
+    uint32_t pos;
+    if (!str_index_find(&doc->template_index.ids[kind], id, &pos)) {
+        doc->parse_stats.templateMisses++;
+        return NULL;
+    }
+    if (doc->template_index.reached)
+        doc->template_index.reached[pos] = true;
+    return doc->template_index.nodes[pos];
+}
+
+static DaTypeTable* find_da_table(const IcdDocument* doc, const char* doType)
+{
+    uint32_t pos;
+    if (!doType || !str_index_find(&doc->da_type_index, doType, &pos) || pos >= doc->da_table_count)
+        return NULL;
+    return &doc->da_tables[pos];
+}
+
+static DaTypeTable* get_or_create_da_table(IcdDocument* doc, Sym doTypeSym)
+{
+    const char* doType = sym_str(doc, doTypeSym);
+    DaTypeTable* table = find_da_table(doc, doType);
+    if (table)
+        return table;
+
+    DaTypeTable* tables = arena_array_reserve(&doc->template_arena, doc->da_tables, doc->da_table_count,
+                                              &doc->da_table_capacity, sizeof(DaTypeTable));
+    if (!tables)
+        return NULL;
+    doc->da_tables = tables;
+
+    if (!str_index_insert(&doc->da_type_index, doType, (uint32_t)doc->da_table_count))
+        return NULL;
+    table = &doc->da_tables[doc->da_table_count++];
+    table->doType = doTypeSym;
+    return table;
+}
+
+static const DAEntry* find_da_entry(const IcdDocument* doc, const char* doType, const char* daPath)
+{
+    if (!doType || !daPath)
+        return NULL;
+    DaTypeTable* table = find_da_table(doc, doType);
+    Sym pathSym = sym_find(doc, daPath);
+    if (!table || pathSym == SYM_NONE)
+        return NULL;
+    char key[24];
+    uint32_t pos;
+    if (!str_index_find(&doc->da_path_index, sym_key2(key, table->doType, pathSym), &pos) || pos >= table->count)
+        return NULL;
+    return &table->items[pos];
+}
+
+/* ---------- Type codes ---------- */
+
+/* bType names compare case-insensitively, as the model builder always did */
+static IcdBType decode_btype(const char* v)
+{
+    if (!v || !*v)
+        return ICD_BTYPE_NONE;
+    switch (toupper((unsigned char)v[0])) {
+    case 'B':
+        if (!strcasecmp(v, "BOOLEAN")) return ICD_BTYPE_BOOLEAN;
+        break;
+    case 'C':
+        if (!strcasecmp(v, "Check")) return ICD_BTYPE_CHECK;
+        break;
+    case 'D':
+        if (!strcasecmp(v, "Dbpos")) return ICD_BTYPE_DBPOS;
+        break;
+    case 'E':
+        if (!strcasecmp(v, "Enum")) return ICD_BTYPE_ENUM;
+        if (!strcasecmp(v, "EntryTime")) return ICD_BTYPE_ENTRYTIME;
+        break;
+    case 'F':
+        if (!strcasecmp(v, "FLOAT32")) return ICD_BTYPE_FLOAT32;
+        if (!strcasecmp(v, "FLOAT64")) return ICD_BTYPE_FLOAT64;
+        break;
+    case 'I':
+        if (!strcasecmp(v, "INT8")) return ICD_BTYPE_INT8;
+        if (!strcasecmp(v, "INT16")) return ICD_BTYPE_INT16;
+        if (!strcasecmp(v, "INT32")) return ICD_BTYPE_INT32;
+        if (!strcasecmp(v, "INT64")) return ICD_BTYPE_INT64;
+        if (!strcasecmp(v, "INT8U")) return ICD_BTYPE_INT8U;
+        if (!strcasecmp(v, "INT16U")) return ICD_BTYPE_INT16U;
+        if (!strcasecmp(v, "INT24U")) return ICD_BTYPE_INT24U;
+        if (!strcasecmp(v, "INT32U")) return ICD_BTYPE_INT32U;
+        break;
+    case 'O':
+        if (!strcasecmp(v, "Octet64")) return ICD_BTYPE_OCTET64;
+        if (!strcasecmp(v, "Octet6")) return ICD_BTYPE_OCTET6;
+        if (!strcasecmp(v, "Octet8")) return ICD_BTYPE_OCTET8;
+        if (!strcasecmp(v, "OptFlds")) return ICD_BTYPE_OPTFLDS;
+        if (!strcasecmp(v, "ObjRef")) return ICD_BTYPE_OBJREF;
+        break;
+    case 'Q':
+        if (!strcasecmp(v, "Quality")) return ICD_BTYPE_QUALITY;
+        break;
+    case 'S':
+        if (!strcasecmp(v, "Struct")) return ICD_BTYPE_STRUCT;
+        break;
+    case 'T':
+        if (!strcasecmp(v, "Timestamp")) return ICD_BTYPE_TIMESTAMP;
+        if (!strcasecmp(v, "TrgOps")) return ICD_BTYPE_TRGOPS;
+        break;
+    case 'U':
+        if (!strcasecmp(v, "Unicode255")) return ICD_BTYPE_UNICODE255;
+        break;
+    case 'V':
+        if (!strcasecmp(v, "VisString32")) return ICD_BTYPE_VISSTRING32;
+        if (!strcasecmp(v, "VisString64")) return ICD_BTYPE_VISSTRING64;
+        if (!strcasecmp(v, "VisString65")) return ICD_BTYPE_VISSTRING65;
+        if (!strcasecmp(v, "VisString129")) return ICD_BTYPE_VISSTRING129;
+        if (!strcasecmp(v, "VisString255")) return ICD_BTYPE_VISSTRING255;
+        break;
+    }
+    return ICD_BTYPE_OTHER;
+}
+
+#define FC_KEY(a, b) ((unsigned)(a) << 8 | (unsigned)(b))
+
+/* FC names are exactly two upper-case letters, so the pair is a perfect key */
+static IcdFc decode_fc(const char* v)
+{
+    if (!v || !*v)
+        return ICD_FC_NONE;
+    if (!v[1] || v[2])
+        return ICD_FC_OTHER;
+    switch (FC_KEY(v[0], v[1])) {
+    case FC_KEY('S', 'T'): return ICD_FC_ST;
+    case FC_KEY('M', 'X'): return ICD_FC_MX;
+    case FC_KEY('S', 'P'): return ICD_FC_SP;
+    case FC_KEY('S', 'V'): return ICD_FC_SV;
+    case FC_KEY('C', 'F'): return ICD_FC_CF;
+    case FC_KEY('D', 'C'): return ICD_FC_DC;
+    case FC_KEY('S', 'G'): return ICD_FC_SG;
+    case FC_KEY('S', 'E'): return ICD_FC_SE;
+    case FC_KEY('S', 'R'): return ICD_FC_SR;
+    case FC_KEY('O', 'R'): return ICD_FC_OR;
+    case FC_KEY('B', 'L'): return ICD_FC_BL;
+    case FC_KEY('E', 'X'): return ICD_FC_EX;
+    case FC_KEY('C', 'O'): return ICD_FC_CO;
+    case FC_KEY('U', 'S'): return ICD_FC_US;
+    case FC_KEY('M', 'S'): return ICD_FC_MS;
+    case FC_KEY('R', 'P'): return ICD_FC_RP;
+    case FC_KEY('B', 'R'): return ICD_FC_BR;
+    case FC_KEY('L', 'G'): return ICD_FC_LG;
+    case FC_KEY('G', 'O'): return ICD_FC_GO;
+    default: return ICD_FC_OTHER;
+    }
+}
+
+static IcdCdc decode_cdc(const char* v)
+{
+    static const struct { const char* name; IcdCdc code; } cdcs[] = {
+        { "SPS", ICD_CDC_SPS }, { "DPS", ICD_CDC_DPS }, { "INS", ICD_CDC_INS }, { "ENS", ICD_CDC_ENS },
+        { "ACT", ICD_CDC_ACT }, { "ACD", ICD_CDC_ACD }, { "SEC", ICD_CDC_SEC }, { "BCR", ICD_CDC_BCR },
+        { "HST", ICD_CDC_HST }, { "VSS", ICD_CDC_VSS }, { "MV", ICD_CDC_MV }, { "CMV", ICD_CDC_CMV },
+        { "SAV", ICD_CDC_SAV }, { "WYE", ICD_CDC_WYE }, { "DEL", ICD_CDC_DEL }, { "SEQ", ICD_CDC_SEQ },
+        { "HMV", ICD_CDC_HMV }, { "HWYE", ICD_CDC_HWYE }, { "HDEL", ICD_CDC_HDEL }, { "SPC", ICD_CDC_SPC },
+        { "DPC", ICD_CDC_DPC }, { "INC", ICD_CDC_INC }, { "ENC", ICD_CDC_ENC }, { "BSC", ICD_CDC_BSC },
+        { "ISC", ICD_CDC_ISC }, { "APC", ICD_CDC_APC }, { "BAC", ICD_CDC_BAC }, { "SPG", ICD_CDC_SPG },
+        { "ING", ICD_CDC_ING }, { "ENG", ICD_CDC_ENG }, { "ORG", ICD_CDC_ORG }, { "TSG", ICD_CDC_TSG },
+        { "CUG", ICD_CDC_CUG }, { "VSG", ICD_CDC_VSG }, { "ASG", ICD_CDC_ASG }, { "CURVE", ICD_CDC_CURVE },
+        { "CSG", ICD_CDC_CSG }, { "DPL", ICD_CDC_DPL }, { "LPL", ICD_CDC_LPL }, { "CSD", ICD_CDC_CSD },
+    };
+    if (!v || !*v)
+        return ICD_CDC_NONE;
+    for (size_t i = 0; i < sizeof(cdcs) / sizeof(cdcs[0]); ++i) {
+        if (cdcs[i].name[0] == v[0] && !strcmp(cdcs[i].name, v))
+            return cdcs[i].code;
+    }
+    return ICD_CDC_OTHER;
 }
 
-static bool xml_attr_true(xmlChar* value) {
+static bool xml_attr_true(const char* value) {
     if (!value)
         return false;
-    bool res = (!xmlStrcmp(value, (const xmlChar*)"true")) || (!xmlStrcmp(value, (const xmlChar*)"TRUE")) ||
-               (!xmlStrcmp(value, (const xmlChar*)"1"));
-    return res;
+    return !strcmp(value, "true") || !strcmp(value, "TRUE") || !strcmp(value, "1");
 }
 
-static void add_da_entry(const char* doType, const char* daPath, const char* fc,
-                         const char* bType, const char* typeId, uint8_t trgOps) {
-    if (!doType || !daPath)
+static void add_da_entry(IcdDocument* doc, Sym doType, const char* daPath, Sym fc, Sym bType, Sym typeId,
+                         uint8_t trgOps) {
+    if (doType == SYM_EMPTY || !daPath)
+        return;
+
+    DaTypeTable* table = get_or_create_da_table(doc, doType);
+    if (!table)
+        return;
+
+    Sym pathSym = sym_intern(doc, daPath);
+    char key[24];
+    sym_key2(key, doType, pathSym);
+    if (str_index_find(&doc->da_path_index, key, NULL))
         return;
 
-    if (da_entry_exists(doType, daPath))
+    DAEntry* items = arena_array_reserve(&doc->template_arena, table->items, table->count,
+                                         &table->capacity, sizeof(DAEntry));
+    if (!items)
+        return;
+    table->items = items;
+    if (!str_index_insert(&doc->da_path_index, key, (uint32_t)table->count))
         return;
 
-    DAEntry* e = calloc(1, sizeof(DAEntry));
-    strncpy(e->doType, doType, sizeof(e->doType) - 1);
-    strncpy(e->daPath, daPath, sizeof(e->daPath) - 1);
-    if (fc)
-        strncpy(e->fc, fc, sizeof(e->fc) - 1);
-    if (bType)
-        strncpy(e->bType, bType, sizeof(e->bType) - 1);
-    if (typeId)
-        strncpy(e->typeId, typeId, sizeof(e->typeId) - 1);
+    DAEntry* e = &table->items[table->count++];
+    e->daPath = pathSym;
+    e->fc = fc;
+    e->bType = bType;
+    e->typeId = typeId;
     e->trgOps = trgOps;
-    e->next = da_list;
-    da_list = e;
+    e->bTypeCode = (uint8_t)decode_btype(sym_str(doc, bType));
+    e->fcCode = (uint8_t)decode_fc(sym_str(doc, fc));
 }
 
-static void add_ln_entry(const char* name, const char* lnClass) {
-    if (!name || !*name || !lnClass || !*lnClass)
+/* ---------- Per-IED tables ---------- */
+
+static IedTables* current_ied(IcdDocument* doc)
+{
+    return doc->cur_ied < doc->ied_count ? &doc->ieds[doc->cur_ied] : NULL;
+}
+
+/* Starts collecting into a new IED. False for an empty or already indexed name: the first definition wins */
+static bool begin_ied(IcdDocument* doc, const char* name)
+{
+    if (!name || !*name || str_index_find(&doc->ied_index, name, NULL))
+        return false;
+
+    IedTables* ieds = arena_array_reserve(&doc->ied_arena, doc->ieds, doc->ied_count, &doc->ied_capacity,
+                                          sizeof(IedTables));
+    if (!ieds)
+        return false;
+    doc->ieds = ieds;
+    if (!str_index_insert(&doc->ied_index, name, (uint32_t)doc->ied_count))
+        return false;
+
+    IedTables* ied = &doc->ieds[doc->ied_count];
+    memset(ied, 0, sizeof(*ied));
+    snprintf(ied->name, sizeof(ied->name), "%s", name);
+    doc->cur_ied = doc->ied_count++;
+    return true;
+}
+
+/* Forgets what was collected from the current AccessPoint. LN classes cover the whole IED and stay. */
+static void reset_ied_access_point(IcdDocument* doc)
+{
+    IedTables* ied = current_ied(doc);
+    if (!ied)
         return;
+    ied->accessPoint[0] = '\0';
+    str_index_clear(&ied->ln_inst_name_index);
+    str_index_clear(&ied->ln_inst_parts_index);
+    str_index_clear(&ied->dataset_index);
+    ied->ln_inst_table = NULL;
+    ied->ln_inst_count = ied->ln_inst_capacity = 0;
+    ied->dataset_table = NULL;
+    ied->dataset_count = ied->dataset_capacity = 0;
+    ied->fcda_table = NULL;
+    ied->fcda_count = ied->fcda_capacity = 0;
+    ied->report_table = NULL;
+    ied->report_count = ied->report_capacity = 0;
+}
 
-    for (LNEntry* e = ln_list; e; e = e->next) {
-        if (!strcmp(e->name, name))
-            return;
+static const IedTables* find_ied(const IcdDocument* doc, const char* iedName)
+{
+    if (!iedName || !*iedName)
+        return doc->default_ied < doc->ied_count ? &doc->ieds[doc->default_ied] : NULL;
+    uint32_t pos;
+    if (!str_index_find(&doc->ied_index, iedName, &pos))
+        return NULL;
+    return &doc->ieds[pos];
+}
+
+/* The requested IED if it was indexed, otherwise the first one */
+static void select_default_ied(IcdDocument* doc, const char* requested)
+{
+    uint32_t pos = 0;
+    if (requested && *requested && !str_index_find(&doc->ied_index, requested, &pos)) {
+        if (doc->ied_count > 0)
+            fprintf(stderr, "Requested IED '%s' not found. Using '%s'.\n", requested, doc->ieds[0].name);
+        pos = 0;
     }
+    doc->default_ied = pos;
+    snprintf(doc->selected_ied_name, sizeof(doc->selected_ied_name), "%s",
+             pos < doc->ied_count ? doc->ieds[pos].name : "");
+    snprintf(doc->selected_ap_name, sizeof(doc->selected_ap_name), "%s",
+             pos < doc->ied_count ? doc->ieds[pos].accessPoint : "");
+}
+
+static void add_ln_entry(IcdDocument* doc, const char* name, const char* lnClass) {
+    IedTables* ied = current_ied(doc);
+    if (!ied || !name || !*name || !lnClass || !*lnClass)
+        return;
 
-    LNEntry* e = calloc(1, sizeof(LNEntry));
-    strncpy(e->name, name, sizeof(e->name) - 1);
-    e->name[sizeof(e->name) - 1] = '\0';
-    strncpy(e->lnClass, lnClass, sizeof(e->lnClass) - 1);
-    e->lnClass[sizeof(e->lnClass) - 1] = '\0';
-    e->next = ln_list;
-    ln_list = e;
+    if (str_index_find(&ied->ln_name_index, name, NULL))
+        return;
+
+    LNEntry* items = arena_array_reserve(&doc->ied_arena, ied->ln_table, ied->ln_count, &ied->ln_capacity, sizeof(LNEntry));
+    if (!items)
+        return;
+    ied->ln_table = items;
+    if (!str_index_insert(&ied->ln_name_index, name, (uint32_t)ied->ln_count))
+        return;
+
+    LNEntry* e = &ied->ln_table[ied->ln_count++];
+    e->name = sym_intern(doc, name);
+    e->lnClass = sym_intern(doc, lnClass);
 }
 
-static void collect_ln_nodes(xmlNode* node) {
-    for (xmlNode* cur = node; cur; cur = cur->next) {
-        if (cur->type != XML_ELEMENT_NODE)
-            continue;
+static void register_ln_class(IcdDocument* doc, xmlNode* lnNode)
+{
+    const char* attrs[LN_ATTR_COUNT];
+    xml_attrs(doc, lnNode, ln_attr_names, attrs, LN_INST + 1);
 
-        if (!xmlStrcmp(cur->name, (const xmlChar*)"LN") || !xmlStrcmp(cur->name, (const xmlChar*)"LN0")) {
-            xmlChar* prefixAttr = xmlGetProp(cur, (const xmlChar*)"prefix");
-            xmlChar* classAttr  = xmlGetProp(cur, (const xmlChar*)"lnClass");
-            xmlChar* instAttr   = xmlGetProp(cur, (const xmlChar*)"inst");
+    const char* prefix = attrs[LN_PREFIX] ? attrs[LN_PREFIX] : "";
+    const char* lnClass = attrs[LN_CLASS] ? attrs[LN_CLASS] : "";
+    const char* inst = attrs[LN_INST] ? attrs[LN_INST] : "";
 
-            const char* prefix = prefixAttr ? (const char*)prefixAttr : "";
-            const char* lnClass = classAttr ? (const char*)classAttr : "";
-            const char* inst = instAttr ? (const char*)instAttr : "";
+    char name[64];
+    if (!xmlStrcmp(lnNode->name, (const xmlChar*)"LN0"))
+        snprintf(name, sizeof(name), "LLN0");
+    else
+        snprintf(name, sizeof(name), "%s%s%s", prefix, lnClass, inst);
 
-            char name[64];
-            if (!xmlStrcmp(cur->name, (const xmlChar*)"LN0"))
-                snprintf(name, sizeof(name), "LLN0");
-            else
-                snprintf(name, sizeof(name), "%s%s%s", prefix, lnClass, inst);
+    add_ln_entry(doc, name, lnClass);
+}
 
-            add_ln_entry(name, lnClass);
+static void collect_ln_nodes(IcdDocument* doc, xmlNode* node) {
+    for (xmlNode* cur = node; cur; cur = cur->next) {
+        if (cur->type != XML_ELEMENT_NODE)
+            continue;
 
-            if (prefixAttr) xmlFree(prefixAttr);
-            if (classAttr) xmlFree(classAttr);
-            if (instAttr) xmlFree(instAttr);
-        }
+        if (!xmlStrcmp(cur->name, (const xmlChar*)"LN") || !xmlStrcmp(cur->name, (const xmlChar*)"LN0"))
+            register_ln_class(doc, cur);
 
         if (cur->children)
-            collect_ln_nodes(cur->children);
+            collect_ln_nodes(doc, cur->children);
     }
 }
 
@@ -240,298 +812,242 @@ static void compose_ln_name(bool isLn0, const char* prefix, const char* lnClass,
         strncat(out, inst, 63 - strlen(out));
 }
 
-static uint32_t parse_uint_attr(xmlChar* attr, uint32_t defaultValue)
+static uint32_t parse_uint_attr(const char* attr, uint32_t defaultValue)
 {
     if (!attr)
         return defaultValue;
     uint32_t value = defaultValue;
     char* end = NULL;
-    unsigned long parsed = strtoul((const char*)attr, &end, 10);
+    unsigned long parsed = strtoul(attr, &end, 10);
     if (end && *end == '\0')
         value = (uint32_t)parsed;
-    xmlFree(attr);
     return value;
 }
 
-static uint8_t parse_trgops_node(xmlNode* node)
+static uint8_t parse_trgops_node(IcdDocument* doc, xmlNode* node)
 {
+    static const char* const names[] = { "dchg", "qchg", "dupd", "period", "gi" };
+    static const uint8_t bits[] = {
+        TRG_OPT_DATA_CHANGED, TRG_OPT_QUALITY_CHANGED, TRG_OPT_DATA_UPDATE, TRG_OPT_INTEGRITY, TRG_OPT_GI
+    };
     uint8_t trgOps = 0;
     if (!node)
         return trgOps;
-    xmlChar* dchgAttr = xmlGetProp(node, (const xmlChar*)"dchg");
-    if (xml_attr_true(dchgAttr)) trgOps |= TRG_OPT_DATA_CHANGED;
-    if (dchgAttr) xmlFree(dchgAttr);
-
-    xmlChar* qchgAttr = xmlGetProp(node, (const xmlChar*)"qchg");
-    if (xml_attr_true(qchgAttr)) trgOps |= TRG_OPT_QUALITY_CHANGED;
-    if (qchgAttr) xmlFree(qchgAttr);
-
-    xmlChar* dupdAttr = xmlGetProp(node, (const xmlChar*)"dupd");
-    if (xml_attr_true(dupdAttr)) trgOps |= TRG_OPT_DATA_UPDATE;
-    if (dupdAttr) xmlFree(dupdAttr);
-
-    xmlChar* periodAttr = xmlGetProp(node, (const xmlChar*)"period");
-    if (xml_attr_true(periodAttr)) trgOps |= TRG_OPT_INTEGRITY;
-    if (periodAttr) xmlFree(periodAttr);
-
-    xmlChar* giAttr = xmlGetProp(node, (const xmlChar*)"gi");
-    if (xml_attr_true(giAttr)) trgOps |= TRG_OPT_GI;
-    if (giAttr) xmlFree(giAttr);
-
+    const char* values[5];
+    xml_attrs(doc, node, names, values, 5);
+    for (size_t i = 0; i < 5; ++i)
+        if (xml_attr_true(values[i])) trgOps |= bits[i];
     return trgOps;
 }
 
-static uint8_t parse_optfields_node(xmlNode* node)
+static uint8_t parse_optfields_node(IcdDocument* doc, xmlNode* node)
 {
+    static const char* const names[] = {
+        "seqNum", "timeStamp", "reasonCode", "dataSet", "dataRef", "bufOvfl", "entryID", "configRef"
+    };
+    static const uint8_t bits[] = {
+        RPT_OPT_SEQ_NUM, RPT_OPT_TIME_STAMP, RPT_OPT_REASON_FOR_INCLUSION, RPT_OPT_DATA_SET,
+        RPT_OPT_DATA_REFERENCE, RPT_OPT_BUFFER_OVERFLOW, RPT_OPT_ENTRY_ID, RPT_OPT_CONF_REV
+    };
     uint8_t opt = 0;
     if (!node)
         return opt;
-    xmlChar* seqAttr = xmlGetProp(node, (const xmlChar*)"seqNum");
-    if (xml_attr_true(seqAttr)) opt |= RPT_OPT_SEQ_NUM;
-    if (seqAttr) xmlFree(seqAttr);
-
-    xmlChar* tsAttr = xmlGetProp(node, (const xmlChar*)"timeStamp");
-    if (xml_attr_true(tsAttr)) opt |= RPT_OPT_TIME_STAMP;
-    if (tsAttr) xmlFree(tsAttr);
-
-    xmlChar* rcAttr = xmlGetProp(node, (const xmlChar*)"reasonCode");
-    if (xml_attr_true(rcAttr)) opt |= RPT_OPT_REASON_FOR_INCLUSION;
-    if (rcAttr) xmlFree(rcAttr);
-
-    xmlChar* dsAttr = xmlGetProp(node, (const xmlChar*)"dataSet");
-    if (xml_attr_true(dsAttr)) opt |= RPT_OPT_DATA_SET;
-    if (dsAttr) xmlFree(dsAttr);
-
-    xmlChar* drAttr = xmlGetProp(node, (const xmlChar*)"dataRef");
-    if (xml_attr_true(drAttr)) opt |= RPT_OPT_DATA_REFERENCE;
-    if (drAttr) xmlFree(drAttr);
-
-    xmlChar* bufAttr = xmlGetProp(node, (const xmlChar*)"bufOvfl");
-    if (xml_attr_true(bufAttr)) opt |= RPT_OPT_BUFFER_OVERFLOW;
-    if (bufAttr) xmlFree(bufAttr);
-
-    xmlChar* entryAttr = xmlGetProp(node, (const xmlChar*)"entryID");
-    if (xml_attr_true(entryAttr)) opt |= RPT_OPT_ENTRY_ID;
-    if (entryAttr) xmlFree(entryAttr);
-
-    xmlChar* confAttr = xmlGetProp(node, (const xmlChar*)"configRef");
-    if (xml_attr_true(confAttr)) opt |= RPT_OPT_CONF_REV;
-    if (confAttr) xmlFree(confAttr);
-
+    const char* values[8];
+    xml_attrs(doc, node, names, values, 8);
+    for (size_t i = 0; i < 8; ++i)
+        if (xml_attr_true(values[i])) opt |= bits[i];
     return opt;
 }
 
-static void add_report_entry(const char* ldInst, const char* lnName, ReportEntry* entry)
+static ReportEntry* add_report_entry(IcdDocument* doc, const char* ldInst, const char* lnName)
 {
-    if (ldInst)
-        snprintf(entry->ldInst, sizeof(entry->ldInst), "%s", ldInst);
-    if (lnName)
-        snprintf(entry->lnName, sizeof(entry->lnName), "%s", lnName);
-    entry->next = report_list;
-    report_list = entry;
+    IedTables* ied = current_ied(doc);
+    if (!ied)
+        return NULL;
+    ReportEntry* items = arena_array_reserve(&doc->ied_arena, ied->report_table, ied->report_count,
+                                             &ied->report_capacity, sizeof(ReportEntry));
+    if (!items)
+        return NULL;
+    ied->report_table = items;
+
+    ReportEntry* entry = &ied->report_table[ied->report_count++];
+    entry->ldInst = sym_intern(doc, ldInst);
+    entry->lnName = sym_intern(doc, lnName);
+    return entry;
 }
 
-static void collect_report_control(xmlNode* rcNode, const char* ldInst, const char* lnName)
+static void collect_report_control(IcdDocument* doc, xmlNode* rcNode, const char* ldInst, const char* lnName)
 {
     if (!rcNode)
         return;
 
-    xmlChar* nameAttr = xmlGetProp(rcNode, (const xmlChar*)"name");
-    if (!nameAttr)
+    enum { RC_NAME, RC_DATSET, RC_RPTID, RC_CONFREV, RC_BUFFERED, RC_INTGPD, RC_BUFTIME, RC_BUFTM, RC_ATTR_COUNT };
+    static const char* const names[RC_ATTR_COUNT] = {
+        "name", "datSet", "rptID", "confRev", "buffered", "intgPd", "bufTime", "bufTm"
+    };
+    const char* attrs[RC_ATTR_COUNT];
+    xml_attrs(doc, rcNode, names, attrs, RC_ATTR_COUNT);
+    if (!attrs[RC_NAME])
         return;
 
-    ReportEntry* entry = calloc(1, sizeof(ReportEntry));
-    if (!entry) {
-        xmlFree(nameAttr);
+    ReportEntry* entry = add_report_entry(doc, ldInst, lnName);
+    if (!entry)
         return;
-    }
-
-    snprintf(entry->name, sizeof(entry->name), "%s", (const char*)nameAttr);
-    xmlFree(nameAttr);
-
-    xmlChar* dsAttr = xmlGetProp(rcNode, (const xmlChar*)"datSet");
-    if (dsAttr) {
-        snprintf(entry->dataSet, sizeof(entry->dataSet), "%s", (const char*)dsAttr);
-        xmlFree(dsAttr);
-    }
-
-    xmlChar* rptAttr = xmlGetProp(rcNode, (const xmlChar*)"rptID");
-    if (rptAttr) {
-        snprintf(entry->rptId, sizeof(entry->rptId), "%s", (const char*)rptAttr);
-        xmlFree(rptAttr);
-    }
-
-    xmlChar* confAttr = xmlGetProp(rcNode, (const xmlChar*)"confRev");
-    entry->confRev = parse_uint_attr(confAttr, 0);
 
-    xmlChar* bufAttr = xmlGetProp(rcNode, (const xmlChar*)"buffered");
-    entry->buffered = xml_attr_true(bufAttr);
-    if (bufAttr) xmlFree(bufAttr);
-
-    xmlChar* intgAttr = xmlGetProp(rcNode, (const xmlChar*)"intgPd");
-    entry->intgPd = parse_uint_attr(intgAttr, 0);
-
-    xmlChar* bufTimeAttr = xmlGetProp(rcNode, (const xmlChar*)"bufTime");
-    entry->bufTime = parse_uint_attr(bufTimeAttr, 0);
-    if (entry->bufTime == 0) {
-        xmlChar* bufTmAttr = xmlGetProp(rcNode, (const xmlChar*)"bufTm");
-        entry->bufTime = parse_uint_attr(bufTmAttr, 0);
-    }
+    entry->name = sym_intern(doc, attrs[RC_NAME]);
+    entry->dataSet = sym_intern(doc, attrs[RC_DATSET]);
+    entry->rptId = sym_intern(doc, attrs[RC_RPTID]);
+    entry->confRev = parse_uint_attr(attrs[RC_CONFREV], 0);
+    entry->buffered = xml_attr_true(attrs[RC_BUFFERED]);
+    entry->intgPd = parse_uint_attr(attrs[RC_INTGPD], 0);
+    entry->bufTime = parse_uint_attr(attrs[RC_BUFTIME], 0);
+    if (entry->bufTime == 0)
+        entry->bufTime = parse_uint_attr(attrs[RC_BUFTM], 0);
 
     for (xmlNode* child = rcNode->children; child; child = child->next) {
         if (child->type != XML_ELEMENT_NODE)
             continue;
         if (xmlStrcmp(child->name, (const xmlChar*)"TrgOps") == 0)
-            entry->trgOps = parse_trgops_node(child);
+            entry->trgOps = parse_trgops_node(doc, child);
         else if (xmlStrcmp(child->name, (const xmlChar*)"OptFields") == 0)
-            entry->optFields = parse_optfields_node(child);
-        else if (xmlStrcmp(child->name, (const xmlChar*)"RptEnabled") == 0) {
-            xmlChar* maxAttr = xmlGetProp(child, (const xmlChar*)"max");
-            entry->rptEnabledMax = (uint16_t)parse_uint_attr(maxAttr, 0);
-        }
+            entry->optFields = parse_optfields_node(doc, child);
+        else if (xmlStrcmp(child->name, (const xmlChar*)"RptEnabled") == 0)
+            entry->rptEnabledMax = (uint16_t)parse_uint_attr(xml_attr(doc, child, "max"), 0);
     }
-
-    add_report_entry(ldInst, lnName, entry);
 }
 
-static void register_ln_instance(const char* ldInst, bool isLn0, const char* prefix,
+static void register_ln_instance(IcdDocument* doc, const char* ldInst, bool isLn0, const char* prefix,
         const char* lnClass, const char* inst, const char* lnType, const char* lnName)
 {
-    if (!lnName)
+    IedTables* ied = current_ied(doc);
+    if (!ied || !lnName)
         return;
 
-    LNInstEntry* e = (LNInstEntry*)calloc(1, sizeof(LNInstEntry));
-    if (!e)
+    LNInstEntry* items = arena_array_reserve(&doc->ied_arena, ied->ln_inst_table, ied->ln_inst_count,
+                                             &ied->ln_inst_capacity, sizeof(LNInstEntry));
+    if (!items)
         return;
-
-    if (ldInst)
-        snprintf(e->ldInst, sizeof(e->ldInst), "%s", ldInst);
-    if (prefix)
-        snprintf(e->prefix, sizeof(e->prefix), "%s", prefix);
-    if (lnClass)
-        snprintf(e->lnClass, sizeof(e->lnClass), "%s", lnClass);
-    if (inst)
-        snprintf(e->lnInst, sizeof(e->lnInst), "%s", inst);
-    if (lnType)
-        snprintf(e->lnType, sizeof(e->lnType), "%s", lnType);
-    snprintf(e->lnName, sizeof(e->lnName), "%s", lnName);
+    ied->ln_inst_table = items;
+
+    LNInstEntry* e = &ied->ln_inst_table[ied->ln_inst_count++];
+    e->ldInst = sym_intern(doc, ldInst);
+    e->prefix = sym_intern(doc, prefix);
+    e->lnClass = sym_intern(doc, lnClass);
+    e->lnInst = sym_intern(doc, inst);
+    e->lnType = sym_intern(doc, lnType);
+    e->lnName = sym_intern(doc, lnName);
     e->isLn0 = isLn0 ? 1 : 0;
 
-    e->next = ln_instances;
-    ln_instances = e;
+    // Lookups answer the first instance in document order, so later duplicates are not indexed
+    uint32_t pos = (uint32_t)(ied->ln_inst_count - 1);
+    char key[288];
+    str_index_insert(&ied->ln_inst_name_index, str_index_key2(key, sizeof(key), ldInst, lnName), pos);
+    str_index_insert(&ied->ln_inst_parts_index, str_index_key4(key, sizeof(key), ldInst, prefix, lnClass, inst), pos);
 }
 
-static DataSetEntryDef* dataset_create(const char* ldInst, const char* lnName, const char* dsName)
+static DataSetEntryDef* dataset_create(IcdDocument* doc, const char* ldInst, const char* lnName, const char* dsName)
 {
-    DataSetEntryDef* ds = calloc(1, sizeof(DataSetEntryDef));
-    if (!ds)
+    IedTables* ied = current_ied(doc);
+    if (!ied)
         return NULL;
-    if (ldInst) snprintf(ds->ldInst, sizeof(ds->ldInst), "%s", ldInst);
-    if (lnName) snprintf(ds->lnName, sizeof(ds->lnName), "%s", lnName);
-    if (dsName) snprintf(ds->name, sizeof(ds->name), "%s", dsName);
-    ds->next = dataset_list;
-    dataset_list = ds;
+    DataSetEntryDef* items = arena_array_reserve(&doc->ied_arena, ied->dataset_table, ied->dataset_count,
+                                                 &ied->dataset_capacity, sizeof(DataSetEntryDef));
+    if (!items)
+        return NULL;
+    ied->dataset_table = items;
+
+    DataSetEntryDef* ds = &ied->dataset_table[ied->dataset_count++];
+    ds->ldInst = sym_intern(doc, ldInst);
+    ds->lnName = sym_intern(doc, lnName);
+    ds->name = sym_intern(doc, dsName);
+    ds->firstMember = ied->fcda_count;
+
+    // A duplicate keeps the index short of dataset_count, which sends lookups back to the scan
+    char key[288];
+    str_index_insert(&ied->dataset_index, str_index_key3(key, sizeof(key), ldInst, lnName, dsName),
+                     (uint32_t)(ied->dataset_count - 1));
     return ds;
 }
 
-static void dataset_add_fcda(DataSetEntryDef* ds, const char* ldInst, const char* prefix,
+static void dataset_add_fcda(IcdDocument* doc, DataSetEntryDef* ds, const char* ldInst, const char* prefix,
         const char* lnClass, const char* lnInst, const char* doName, const char* daName, const char* fc)
 {
-    if (!ds)
+    IedTables* ied = current_ied(doc);
+    if (!ied || !ds)
         return;
-    FcdaEntry* entry = calloc(1, sizeof(FcdaEntry));
-    if (!entry)
+    FcdaEntry* items = arena_array_reserve(&doc->ied_arena, ied->fcda_table, ied->fcda_count,
+                                           &ied->fcda_capacity, sizeof(FcdaEntry));
+    if (!items)
         return;
-    if (ldInst) snprintf(entry->ldInst, sizeof(entry->ldInst), "%s", ldInst);
-    if (prefix) snprintf(entry->prefix, sizeof(entry->prefix), "%s", prefix);
-    if (lnClass) snprintf(entry->lnClass, sizeof(entry->lnClass), "%s", lnClass);
-    if (lnInst) snprintf(entry->lnInst, sizeof(entry->lnInst), "%s", lnInst);
-    if (doName) snprintf(entry->doName, sizeof(entry->doName), "%s", doName);
-    if (daName) snprintf(entry->daName, sizeof(entry->daName), "%s", daName);
-    if (fc) snprintf(entry->fc, sizeof(entry->fc), "%s", fc);
-    entry->next = ds->members;
-    ds->members = entry;
+    ied->fcda_table = items;
+
+    // FCDAs of one DataSet are appended back to back
+    FcdaEntry* entry = &ied->fcda_table[ied->fcda_count++];
+    ds->memberCount++;
+    entry->ldInst = sym_intern(doc, ldInst);
+    entry->prefix = sym_intern(doc, prefix);
+    entry->lnClass = sym_intern(doc, lnClass);
+    entry->lnInst = sym_intern(doc, lnInst);
+    entry->doName = sym_intern(doc, doName);
+    entry->daName = sym_intern(doc, daName);
+    entry->fc = sym_intern(doc, fc);
 }
 
-static void process_ln_for_datasets(xmlNode* lnNode, const char* ldInst)
+static void process_ln_for_datasets(IcdDocument* doc, xmlNode* lnNode, const char* ldInst)
 {
     bool isLn0 = (xmlStrcmp(lnNode->name, (const xmlChar*)"LN0") == 0);
-    xmlChar* prefixAttr = xmlGetProp(lnNode, (const xmlChar*)"prefix");
-    xmlChar* classAttr  = xmlGetProp(lnNode, (const xmlChar*)"lnClass");
-    xmlChar* instAttr   = xmlGetProp(lnNode, (const xmlChar*)"inst");
+    const char* attrs[LN_ATTR_COUNT];
+    xml_attrs(doc, lnNode, ln_attr_names, attrs, LN_ATTR_COUNT);
 
-    const char* prefix = prefixAttr ? (const char*)prefixAttr : "";
-    const char* lnClass = classAttr ? (const char*)classAttr : "";
-    const char* inst = instAttr ? (const char*)instAttr : "";
+    const char* prefix = attrs[LN_PREFIX] ? attrs[LN_PREFIX] : "";
+    const char* lnClass = attrs[LN_CLASS] ? attrs[LN_CLASS] : "";
+    const char* inst = attrs[LN_INST] ? attrs[LN_INST] : "";
+    const char* lnTypeId = attrs[LN_TYPE] ? attrs[LN_TYPE] : "";
 
     char lnName[64];
     compose_ln_name(isLn0, prefix, lnClass, inst, lnName);
 
-    xmlChar* lnTypeAttr = xmlGetProp(lnNode, (const xmlChar*)"lnType");
-    const char* lnTypeId = lnTypeAttr ? (const char*)lnTypeAttr : "";
-
-    register_ln_instance(ldInst, isLn0, prefix, lnClass, inst, lnTypeId, lnName);
-
-    if (lnTypeAttr) xmlFree(lnTypeAttr);
+    register_ln_instance(doc, ldInst, isLn0, prefix, lnClass, inst, lnTypeId, lnName);
 
     for (xmlNode* child = lnNode->children; child; child = child->next) {
         if (child->type != XML_ELEMENT_NODE)
             continue;
 
         if (xmlStrcmp(child->name, (const xmlChar*)"DataSet") == 0) {
-            xmlChar* dsNameAttr = xmlGetProp(child, (const xmlChar*)"name");
-            if (!dsNameAttr)
+            const char* dsName = xml_attr(doc, child, "name");
+            if (!dsName)
                 continue;
-            DataSetEntryDef* ds = dataset_create(ldInst ? ldInst : "", lnName, (const char*)dsNameAttr);
+            DataSetEntryDef* ds = dataset_create(doc, ldInst ? ldInst : "", lnName, dsName);
             for (xmlNode* fcda = child->children; fcda; fcda = fcda->next) {
                 if (fcda->type != XML_ELEMENT_NODE)
                     continue;
                 if (xmlStrcmp(fcda->name, (const xmlChar*)"FCDA") != 0)
                     continue;
-                xmlChar* ldAttr = xmlGetProp(fcda, (const xmlChar*)"ldInst");
-                xmlChar* prefixAttrFc = xmlGetProp(fcda, (const xmlChar*)"prefix");
-                xmlChar* lcAttr = xmlGetProp(fcda, (const xmlChar*)"lnClass");
-                xmlChar* liAttr = xmlGetProp(fcda, (const xmlChar*)"lnInst");
-                xmlChar* doAttr = xmlGetProp(fcda, (const xmlChar*)"doName");
-                xmlChar* daAttr = xmlGetProp(fcda, (const xmlChar*)"daName");
-                xmlChar* fcAttr = xmlGetProp(fcda, (const xmlChar*)"fc");
-                dataset_add_fcda(ds,
-                    ldAttr ? (const char*)ldAttr : "",
-                    prefixAttrFc ? (const char*)prefixAttrFc : "",
-                    lcAttr ? (const char*)lcAttr : "",
-                    liAttr ? (const char*)liAttr : "",
-                    doAttr ? (const char*)doAttr : "",
-                    daAttr ? (const char*)daAttr : "",
-                    fcAttr ? (const char*)fcAttr : "");
-                if (ldAttr) xmlFree(ldAttr);
-                if (prefixAttrFc) xmlFree(prefixAttrFc);
-                if (lcAttr) xmlFree(lcAttr);
-                if (liAttr) xmlFree(liAttr);
-                if (doAttr) xmlFree(doAttr);
-                if (daAttr) xmlFree(daAttr);
-                if (fcAttr) xmlFree(fcAttr);
+                static const char* const fcdaNames[] = {
+                    "ldInst", "prefix", "lnClass", "lnInst", "doName", "daName", "fc"
+                };
+                const char* v[7];
+                xml_attrs(doc, fcda, fcdaNames, v, 7);
+                dataset_add_fcda(doc, ds,
+                    v[0] ? v[0] : "", v[1] ? v[1] : "", v[2] ? v[2] : "", v[3] ? v[3] : "",
+                    v[4] ? v[4] : "", v[5] ? v[5] : "", v[6] ? v[6] : "");
             }
-            xmlFree(dsNameAttr);
         }
         else if (xmlStrcmp(child->name, (const xmlChar*)"ReportControl") == 0) {
-            collect_report_control(child, ldInst, lnName);
+            collect_report_control(doc, child, ldInst, lnName);
         }
     }
-
-    if (prefixAttr) xmlFree(prefixAttr);
-    if (classAttr) xmlFree(classAttr);
-    if (instAttr) xmlFree(instAttr);
 }
 
-static xmlNode* find_active_ied(xmlNode* root)
+static xmlNode* find_active_ied(IcdDocument* doc, xmlNode* root)
 {
     if (!root)
         return NULL;
 
-    bool hadPreference = (selected_ied_name[0] != '\0');
+    bool hadPreference = (doc->selected_ied_name[0] != '\0');
     char requested[64] = {0};
     if (hadPreference)
-        snprintf(requested, sizeof(requested), "%s", selected_ied_name);
+        snprintf(requested, sizeof(requested), "%s", doc->selected_ied_name);
 
     xmlNode* firstMatch = NULL;
     for (xmlNode* ied = root->children; ied; ied = ied->next) {
@@ -540,40 +1056,36 @@ static xmlNode* find_active_ied(xmlNode* root)
         if (xmlStrcmp(ied->name, (const xmlChar*)"IED") != 0)
             continue;
 
-        xmlChar* nameAttr = xmlGetProp(ied, (const xmlChar*)"name");
-        const char* name = nameAttr ? (const char*)nameAttr : "";
-        if (!firstMatch && name && *name)
+        const char* name = xml_attr(doc, ied, "name");
+        if (!name)
+            name = "";
+        if (!firstMatch && *name)
             firstMatch = ied;
 
-        if (!selected_ied_name[0] && name && *name)
-            set_selected_ied(name);
+        if (!doc->selected_ied_name[0] && *name)
+            set_selected_ied(doc, name);
 
-        if (selected_ied_name[0] && name && *name && strcmp(selected_ied_name, name) == 0) {
-            if (nameAttr) xmlFree(nameAttr);
+        if (doc->selected_ied_name[0] && *name && strcmp(doc->selected_ied_name, name) == 0)
             return ied;
-        }
-        if (nameAttr) xmlFree(nameAttr);
     }
 
     if (firstMatch) {
-        xmlChar* nameAttr = xmlGetProp(firstMatch, (const xmlChar*)"name");
-        const char* fallback = nameAttr ? (const char*)nameAttr : "";
+        const char* fallback = xml_attr(doc, firstMatch, "name");
         if (fallback && *fallback) {
             if (hadPreference && strcmp(requested, fallback) != 0)
                 fprintf(stderr, "Requested IED '%s' not found. Using '%s'.\n", requested, fallback);
-            snprintf(selected_ied_name, sizeof(selected_ied_name), "%s", fallback);
-            selected_ap_name[0] = '\0';
+            snprintf(doc->selected_ied_name, sizeof(doc->selected_ied_name), "%s", fallback);
+            doc->selected_ap_name[0] = '\0';
         }
-        if (nameAttr) xmlFree(nameAttr);
     } else if (hadPreference) {
         fprintf(stderr, "Requested IED '%s' not found in SCL file.\n", requested);
-        selected_ied_name[0] = '\0';
+        doc->selected_ied_name[0] = '\0';
     }
 
     return firstMatch;
 }
 
-static void process_access_point(xmlNode* ap)
+static void process_access_point(IcdDocument* doc, xmlNode* ap)
 {
     for (xmlNode* server = ap->children; server; server = server->next) {
         if (server->type != XML_ELEMENT_NODE)
@@ -585,29 +1097,30 @@ static void process_access_point(xmlNode* ap)
                 continue;
             if (xmlStrcmp(ld->name, (const xmlChar*)"LDevice") != 0)
                 continue;
-            xmlChar* instAttr = xmlGetProp(ld, (const xmlChar*)"inst");
-            const char* ldInst = instAttr ? (const char*)instAttr : "";
+            const char* ldInst = xml_attr(doc, ld, "inst");
+            if (!ldInst)
+                ldInst = "";
             for (xmlNode* ln = ld->children; ln; ln = ln->next) {
                 if (ln->type != XML_ELEMENT_NODE)
                     continue;
                 if (xmlStrcmp(ln->name, (const xmlChar*)"LN") == 0 ||
                     xmlStrcmp(ln->name, (const xmlChar*)"LN0") == 0)
-                    process_ln_for_datasets(ln, ldInst);
+                    process_ln_for_datasets(doc, ln, ldInst);
             }
-            if (instAttr) xmlFree(instAttr);
         }
     }
 }
 
-static void collect_dataset_nodes(xmlNode* iedNode)
+/* accessPoint holds the preferred AccessPoint on entry and the one collected on return */
+static void collect_dataset_nodes(IcdDocument* doc, xmlNode* iedNode, char accessPoint[64])
 {
     if (!iedNode)
         return;
 
-    bool hadPreference = (selected_ap_name[0] != '\0');
+    bool hadPreference = (accessPoint[0] != '\0');
     char requested[64] = {0};
     if (hadPreference)
-        snprintf(requested, sizeof(requested), "%s", selected_ap_name);
+        snprintf(requested, sizeof(requested), "%s", accessPoint);
 
     xmlNode* firstAp = NULL;
     char firstApName[64] = {0};
@@ -618,8 +1131,9 @@ static void collect_dataset_nodes(xmlNode* iedNode)
         if (xmlStrcmp(ap->name, (const xmlChar*)"AccessPoint") != 0)
             continue;
 
-        xmlChar* apNameAttr = xmlGetProp(ap, (const xmlChar*)"name");
-        const char* apName = apNameAttr ? (const char*)apNameAttr : "";
+        const char* apName = xml_attr(doc, ap, "name");
+        if (!apName)
+            apName = "";
         if (!firstAp) {
             firstAp = ap;
             if (apName && *apName)
@@ -628,17 +1142,16 @@ static void collect_dataset_nodes(xmlNode* iedNode)
                 firstApName[0] = '\0';
         }
 
-        if (!selected_ap_name[0] && apName && *apName)
-            set_selected_ap(apName);
+        if (!accessPoint[0] && apName && *apName)
+            snprintf(accessPoint, 64, "%s", apName);
 
-        bool apMatches = (!selected_ap_name[0]) ||
-                         (apName && *apName && strcmp(selected_ap_name, apName) == 0);
-        if (apNameAttr) xmlFree(apNameAttr);
+        bool apMatches = (!accessPoint[0]) ||
+                         (apName && *apName && strcmp(accessPoint, apName) == 0);
 
         if (!apMatches)
             continue;
 
-        process_access_point(ap);
+        process_access_point(doc, ap);
         return;
     }
 
@@ -647,114 +1160,118 @@ static void collect_dataset_nodes(xmlNode* iedNode)
             const char* fallbackLabel = firstApName[0] ? firstApName : "<unnamed>";
             fprintf(stderr, "Requested AccessPoint '%s' not found. Using '%s'.\n", requested, fallbackLabel);
         }
-        snprintf(selected_ap_name, sizeof(selected_ap_name), "%s", firstApName);
-        process_access_point(firstAp);
+        snprintf(accessPoint, 64, "%s", firstApName);
+        process_access_point(doc, firstAp);
     } else if (hadPreference) {
-        fprintf(stderr, "Requested AccessPoint '%s' not found in IED '%s'.\n", requested, selected_ied_name);
-        selected_ap_name[0] = '\0';
+        IedTables* ied = current_ied(doc);
+        fprintf(stderr, "Requested AccessPoint '%s' not found in IED '%s'.\n", requested, ied ? ied->name : "");
+        accessPoint[0] = '\0';
     }
 }
 
+static void collect_ied(IcdDocument* doc, xmlNode* iedNode, char accessPoint[64])
+{
+    collect_ln_nodes(doc, iedNode->children);  // not the sibling IEDs
+    collect_dataset_nodes(doc, iedNode, accessPoint);
+    IedTables* ied = current_ied(doc);
+    if (ied)
+        snprintf(ied->accessPoint, sizeof(ied->accessPoint), "%s", accessPoint);
+}
 
-static void collect_da_type(xmlNode* templates, const char* doTypeId, const char* daTypeId,
-                            const char* prefix, const char* inheritedFc, uint8_t inheritedTrgOps);
-
-static void collect_do_type(xmlNode* templates, const char* doTypeId, const char* prefix) {
-    if (!templates || !doTypeId)
-        return;
-
-    xmlNode* doTypeNode = find_node(templates->children, "DOType", "id", doTypeId);
-    if (!doTypeNode)
-        return;
+/* Every named IED gets its own tables; the requested AccessPoint applies to each IED that has one */
+static void collect_all_ieds(IcdDocument* doc, xmlNode* root)
+{
+    char requestedIed[64];
+    snprintf(requestedIed, sizeof(requestedIed), "%s", doc->selected_ied_name);
 
-    for (xmlNode* child = doTypeNode->children; child; child = child->next) {
-        if (child->type != XML_ELEMENT_NODE)
+    for (xmlNode* iedNode = root->children; iedNode; iedNode = iedNode->next) {
+        if (iedNode->type != XML_ELEMENT_NODE || xmlStrcmp(iedNode->name, (const xmlChar*)"IED") != 0)
             continue;
+        if (!begin_ied(doc, xml_attr(doc, iedNode, "name")))
+            continue;
+        char accessPoint[64];
+        snprintf(accessPoint, sizeof(accessPoint), "%s", doc->selected_ap_name);
+        collect_ied(doc, iedNode, accessPoint);
+    }
 
-        if (xmlStrcmp(child->name, (const xmlChar*)"DA") == 0) {
-            xmlChar* nameAttr = xmlGetProp(child, (const xmlChar*)"name");
-            xmlChar* fcAttr   = xmlGetProp(child, (const xmlChar*)"fc");
-            xmlChar* bTypeAttr= xmlGetProp(child, (const xmlChar*)"bType");
-            xmlChar* typeAttr = xmlGetProp(child, (const xmlChar*)"type");
-            xmlChar* dchgAttr = xmlGetProp(child, (const xmlChar*)"dchg");
-            xmlChar* qchgAttr = xmlGetProp(child, (const xmlChar*)"qchg");
-            xmlChar* dupdAttr = xmlGetProp(child, (const xmlChar*)"dupd");
-
-            if (!nameAttr || !bTypeAttr) {
-                if (nameAttr) xmlFree(nameAttr);
-                if (fcAttr) xmlFree(fcAttr);
-                if (bTypeAttr) xmlFree(bTypeAttr);
-                if (typeAttr) xmlFree(typeAttr);
-                if (dchgAttr) xmlFree(dchgAttr);
-                if (qchgAttr) xmlFree(qchgAttr);
-                if (dupdAttr) xmlFree(dupdAttr);
-                continue;
-            }
-
-            char path[256];
-            const char* nameStr = (const char*)nameAttr;
-            if (prefix && prefix[0])
-                snprintf(path, sizeof(path), "%s.%s", prefix, nameStr);
-            else
-                snprintf(path, sizeof(path), "%s", nameStr);
-
-            const char* fcStr = fcAttr ? (const char*)fcAttr : NULL;
-            const char* bTypeStr = (const char*)bTypeAttr;
-            uint8_t trgOps = 0;
-            if (xml_attr_true(dchgAttr)) trgOps |= TRG_OPT_DATA_CHANGED;
-            if (xml_attr_true(qchgAttr)) trgOps |= TRG_OPT_QUALITY_CHANGED;
-            if (xml_attr_true(dupdAttr)) trgOps |= TRG_OPT_DATA_UPDATE;
-
-            const char* typeStr = typeAttr ? (const char*)typeAttr : NULL;
-
-            add_da_entry(doTypeId, path, fcStr, bTypeStr, typeStr, trgOps);
-
-            if (typeAttr)
-                collect_da_type(templates, doTypeId, (const char*)typeAttr, path, fcStr, trgOps);
+    select_default_ied(doc, requestedIed);
+}
 
-            xmlFree(nameAttr);
-            if (fcAttr) xmlFree(fcAttr);
-            xmlFree(bTypeAttr);
-            if (typeAttr) xmlFree(typeAttr);
-            if (dchgAttr) xmlFree(dchgAttr);
-            if (qchgAttr) xmlFree(qchgAttr);
-            if (dupdAttr) xmlFree(dupdAttr);
-        }
-        else if (xmlStrcmp(child->name, (const xmlChar*)"SDO") == 0) {
-            xmlChar* nameAttr = xmlGetProp(child, (const xmlChar*)"name");
-            xmlChar* typeAttr = xmlGetProp(child, (const xmlChar*)"type");
-            if (!nameAttr || !typeAttr) {
-                if (nameAttr) xmlFree(nameAttr);
-                if (typeAttr) xmlFree(typeAttr);
-                continue;
-            }
 
-            char path[256];
-            const char* nameStr = (const char*)nameAttr;
-            if (prefix && prefix[0])
-                snprintf(path, sizeof(path), "%s.%s", prefix, nameStr);
-            else
-                snprintf(path, sizeof(path), "%s", nameStr);
+/* ---------- DAType expansion cache ---------- */
 
-            collect_do_type(templates, (const char*)typeAttr, path);
+static void expansion_cache_free(IcdDocument* doc)
+{
+    for (size_t i = 0; i < doc->da_type_cache_count; ++i)
+        free(doc->da_type_cache[i].items);
+    free(doc->da_type_cache);
+    doc->da_type_cache = NULL;
+    doc->da_type_cache_count = 0;
+    doc->da_type_cache_capacity = 0;
+    str_index_free(&doc->da_type_cache_index);
+    str_index_free(&doc->expanded_do_types);
+}
 
-            xmlFree(nameAttr);
-            xmlFree(typeAttr);
-        }
+static DaTypeCacheEntry* da_type_cache_append(IcdDocument* doc, size_t pos)
+{
+    DaTypeExpansion* exp = &doc->da_type_cache[pos];
+    if (exp->count == exp->capacity) {
+        size_t newCap = exp->capacity ? exp->capacity * 2 : 8;
+        DaTypeCacheEntry* items = realloc(exp->items, newCap * sizeof(DaTypeCacheEntry));
+        if (!items)
+            return NULL;
+        exp->items = items;
+        exp->capacity = newCap;
     }
+    DaTypeCacheEntry* e = &exp->items[exp->count++];
+    memset(e, 0, sizeof(*e));
+    return e;
 }
 
-static void collect_da_type(xmlNode* templates, const char* doTypeId, const char* daTypeId,
-                            const char* prefix, const char* inheritedFc, uint8_t inheritedTrgOps)
+static uint8_t trgops_from_attrs(const char* dchgAttr, const char* qchgAttr, const char* dupdAttr)
 {
-    if (!templates || !daTypeId)
-        return;
+    uint8_t trgOps = 0;
+    if (xml_attr_true(dchgAttr)) trgOps |= TRG_OPT_DATA_CHANGED;
+    if (xml_attr_true(qchgAttr)) trgOps |= TRG_OPT_QUALITY_CHANGED;
+    if (xml_attr_true(dupdAttr)) trgOps |= TRG_OPT_DATA_UPDATE;
+    return trgOps;
+}
 
-    xmlNode* daTypeNode = find_node(templates->children, "DAType", "id", daTypeId);
-    if (!daTypeNode)
-        return;
+/*
+ * Expand a DAType once into a flat list of relative BDA paths. Returns the
+ * position in doc->da_type_cache, or -1 for unknown types and reference cycles.
+ */
+static long expand_da_type(IcdDocument* doc, const char* daTypeId)
+{
+    if (!daTypeId)
+        return -1;
+
+    uint32_t cached;
+    if (str_index_find(&doc->da_type_cache_index, daTypeId, &cached)) {
+        if (doc->da_type_cache[cached].state == DATYPE_BUILDING)
+            return -1;
+        doc->parse_stats.daTypeReuses++;
+        return (long)cached;
+    }
 
-    for (xmlNode* child = daTypeNode->children; child; child = child->next) {
+    if (doc->da_type_cache_count == doc->da_type_cache_capacity) {
+        size_t newCap = doc->da_type_cache_capacity ? doc->da_type_cache_capacity * 2 : 64;
+        DaTypeExpansion* cache = realloc(doc->da_type_cache, newCap * sizeof(DaTypeExpansion));
+        if (!cache)
+            return -1;
+        doc->da_type_cache = cache;
+        doc->da_type_cache_capacity = newCap;
+    }
+    size_t pos = doc->da_type_cache_count;
+    if (!str_index_insert(&doc->da_type_cache_index, daTypeId, (uint32_t)pos))
+        return -1;
+    memset(&doc->da_type_cache[pos], 0, sizeof(DaTypeExpansion));
+    doc->da_type_cache[pos].state = DATYPE_BUILDING;
+    doc->da_type_cache_count++;
+    doc->parse_stats.daTypeExpansions++;
+
+    xmlNode* daTypeNode = find_template(doc, TEMPLATE_DATYPE, daTypeId);
+    for (xmlNode* child = daTypeNode ? daTypeNode->children : NULL; child; child = child->next) {
         if (child->type != XML_ELEMENT_NODE)
             continue;
 
@@ -762,333 +1279,1208 @@ static void collect_da_type(xmlNode* templates, const char* doTypeId, const char
             xmlStrcmp(child->name, (const xmlChar*)"DA")  != 0)
             continue;
 
-        xmlChar* nameAttr = xmlGetProp(child, (const xmlChar*)"name");
-        xmlChar* fcAttr   = xmlGetProp(child, (const xmlChar*)"fc");
-        xmlChar* bTypeAttr= xmlGetProp(child, (const xmlChar*)"bType");
-        xmlChar* typeAttr = xmlGetProp(child, (const xmlChar*)"type");
-        xmlChar* dchgAttr = xmlGetProp(child, (const xmlChar*)"dchg");
-        xmlChar* qchgAttr = xmlGetProp(child, (const xmlChar*)"qchg");
-        xmlChar* dupdAttr = xmlGetProp(child, (const xmlChar*)"dupd");
-
-        if (!nameAttr) {
-            if (fcAttr) xmlFree(fcAttr);
-            if (bTypeAttr) xmlFree(bTypeAttr);
-            if (typeAttr) xmlFree(typeAttr);
-            if (dchgAttr) xmlFree(dchgAttr);
-            if (qchgAttr) xmlFree(qchgAttr);
-            if (dupdAttr) xmlFree(dupdAttr);
+        const char* a[DA_ATTR_COUNT];
+        xml_attrs(doc, child, da_attr_names, a, DA_ATTR_COUNT);
+        if (!a[DA_NAME])
             continue;
-        }
 
-        char path[256];
-        const char* nameStr = (const char*)nameAttr;
-        if (prefix && prefix[0])
-            snprintf(path, sizeof(path), "%s.%s", prefix, nameStr);
-        else
-            snprintf(path, sizeof(path), "%s", nameStr);
-
-        const char* fcStr = fcAttr ? (const char*)fcAttr : inheritedFc;
-        const char* bTypeStr = bTypeAttr ? (const char*)bTypeAttr : NULL;
-        uint8_t trgOps = inheritedTrgOps;
-        if (dchgAttr || qchgAttr || dupdAttr) {
-            trgOps = 0;
-            if (xml_attr_true(dchgAttr)) trgOps |= TRG_OPT_DATA_CHANGED;
-            if (xml_attr_true(qchgAttr)) trgOps |= TRG_OPT_QUALITY_CHANGED;
-            if (xml_attr_true(dupdAttr)) trgOps |= TRG_OPT_DATA_UPDATE;
+        DaTypeCacheEntry* e = da_type_cache_append(doc, pos);
+        if (e) {
+            e->relPath = sym_intern(doc, a[DA_NAME]);
+            e->fc = sym_intern(doc, a[DA_FC]);
+            e->bType = sym_intern(doc, a[DA_BTYPE]);
+            e->typeId = sym_intern(doc, a[DA_TYPE]);
+            e->hasTrgOps = (a[DA_DCHG] || a[DA_QCHG] || a[DA_DUPD]);
+            if (e->hasTrgOps)
+                e->trgOps = trgops_from_attrs(a[DA_DCHG], a[DA_QCHG], a[DA_DUPD]);
         }
 
-        const char* typeStr = typeAttr ? (const char*)typeAttr : NULL;
+        if (e && a[DA_TYPE] && (!a[DA_BTYPE] || strcmp(a[DA_BTYPE], "Enum") != 0)) {
+            DaTypeCacheEntry parent = *e;   // the append below may move the array
+            long sub = expand_da_type(doc, a[DA_TYPE]);
+            for (size_t i = 0; sub >= 0 && i < doc->da_type_cache[sub].count; ++i) {
+                DaTypeCacheEntry subEntry = doc->da_type_cache[sub].items[i];
+                JoinBuf relPath;
+                if (!join2(&relPath, sym_str(doc, parent.relPath), '.', sym_str(doc, subEntry.relPath))) {
+                    fprintf(stderr, "⚠️ Out of memory for a BDA path in DAType %s, skipped\n", daTypeId);
+                    continue;
+                }
+                DaTypeCacheEntry* nested = da_type_cache_append(doc, pos);
+                if (!nested) {
+                    join_free(&relPath);
+                    break;
+                }
+                *nested = subEntry;
+                nested->relPath = sym_intern(doc, relPath.str);
+                join_free(&relPath);
+                if (subEntry.fc == SYM_EMPTY)
+                    nested->fc = parent.fc;
+                if (!subEntry.hasTrgOps) {
+                    nested->hasTrgOps = parent.hasTrgOps;
+                    nested->trgOps = parent.trgOps;
+                }
+            }
+        }
+    }
 
-        add_da_entry(doTypeId, path, fcStr, bTypeStr, typeStr, trgOps);
+    doc->da_type_cache[pos].state = DATYPE_BUILT;
+    return (long)pos;
+}
 
-        if (typeAttr)
-            collect_da_type(templates, doTypeId, (const char*)typeAttr, path, fcStr, trgOps);
+/* Graft a cached DAType subtree under the DA at prefix */
+static void graft_da_type(IcdDocument* doc, Sym doTypeId, const char* daTypeId, const char* prefix,
+                          Sym inheritedFc, uint8_t inheritedTrgOps)
+{
+    long pos = expand_da_type(doc, daTypeId);
+    if (pos < 0)
+        return;
 
-        xmlFree(nameAttr);
-        if (fcAttr) xmlFree(fcAttr);
-        if (bTypeAttr) xmlFree(bTypeAttr);
-        if (typeAttr) xmlFree(typeAttr);
-        if (dchgAttr) xmlFree(dchgAttr);
-        if (qchgAttr) xmlFree(qchgAttr);
-        if (dupdAttr) xmlFree(dupdAttr);
+    const DaTypeExpansion* exp = &doc->da_type_cache[pos];
+    for (size_t i = 0; i < exp->count; ++i) {
+        const DaTypeCacheEntry* e = &exp->items[i];
+        JoinBuf path;
+        if (!join2(&path, prefix, '.', sym_str(doc, e->relPath))) {
+            fprintf(stderr, "⚠️ Out of memory for a DA path below %s, skipped\n", prefix);
+            continue;
+        }
+        add_da_entry(doc, doTypeId, path.str,
+                     e->fc != SYM_EMPTY ? e->fc : inheritedFc,
+                     e->bType, e->typeId,
+                     e->hasTrgOps ? e->trgOps : inheritedTrgOps);
+        join_free(&path);
     }
 }
 
-static void parse_icd(xmlDocPtr doc) {
-    xmlNode* root = xmlDocGetRootElement(doc);
-    xmlNode* templates = find_node(root->children, "DataTypeTemplates", NULL, NULL);
-    if (!templates) return;
+static void collect_do_type(IcdDocument* doc, const char* doTypeId, const char* prefix) {
+    if (!doTypeId)
+        return;
+
+    // A DOType (or SDO subtree) expands to the same entries every time
+    JoinBuf key;
+    if (!join2(&key, doTypeId, '\x1f', prefix ? prefix : "")) {
+        fprintf(stderr, "⚠️ Out of memory expanding DOType %s, skipped\n", doTypeId);
+        return;
+    }
+    bool expanded = !str_index_insert(&doc->expanded_do_types, key.str, 0);
+    join_free(&key);
+    if (expanded) {
+        doc->parse_stats.doTypeReuses++;
+        return;
+    }
+    doc->parse_stats.doTypeExpansions++;
+
+    xmlNode* doTypeNode = find_template(doc, TEMPLATE_DOTYPE, doTypeId);
+    if (!doTypeNode)
+        return;
+    Sym doTypeSym = sym_intern(doc, doTypeId);
+
+    for (xmlNode* child = doTypeNode->children; child; child = child->next) {
+        if (child->type != XML_ELEMENT_NODE)
+            continue;
+
+        if (xmlStrcmp(child->name, (const xmlChar*)"DA") == 0) {
+            const char* a[DA_ATTR_COUNT];
+            xml_attrs(doc, child, da_attr_names, a, DA_ATTR_COUNT);
+            if (!a[DA_NAME] || !a[DA_BTYPE])
+                continue;
+
+            JoinBuf joined = { .str = NULL };
+            const char* path = prefix && prefix[0] ? join2(&joined, prefix, '.', a[DA_NAME]) : a[DA_NAME];
+            if (!path) {
+                fprintf(stderr, "⚠️ Out of memory for DA %s below %s, skipped\n", a[DA_NAME], prefix);
+                continue;
+            }
+
+            uint8_t trgOps = trgops_from_attrs(a[DA_DCHG], a[DA_QCHG], a[DA_DUPD]);
+            Sym fc = sym_intern(doc, a[DA_FC]);
+            add_da_entry(doc, doTypeSym, path, fc, sym_intern(doc, a[DA_BTYPE]), sym_intern(doc, a[DA_TYPE]), trgOps);
+
+            // Enum DAs reference an EnumType, not a DAType: nothing to expand
+            if (a[DA_TYPE] && strcmp(a[DA_BTYPE], "Enum") != 0)
+                graft_da_type(doc, doTypeSym, a[DA_TYPE], path, fc, trgOps);
+            join_free(&joined);
+        }
+        else if (xmlStrcmp(child->name, (const xmlChar*)"SDO") == 0) {
+            const char* a[2];
+            xml_attrs(doc, child, name_type_attr_names, a, 2);
+            if (!a[0] || !a[1])
+                continue;
+
+            JoinBuf joined = { .str = NULL };
+            const char* path = prefix && prefix[0] ? join2(&joined, prefix, '.', a[0]) : a[0];
+            if (!path) {
+                fprintf(stderr, "⚠️ Out of memory for SDO %s below %s, skipped\n", a[0], prefix);
+                continue;
+            }
+            collect_do_type(doc, a[1], path);
+            join_free(&joined);
+        }
+    }
+}
+
+/* Expands the LNodeTypes listed in lnTypes (all of them if NULL) and their DOType/DAType closure */
+static void expand_templates(IcdDocument* doc, xmlNode* templates, const StrIndex* lnTypes)
+{
+    build_template_index(doc, templates);
 
     // LNodeType → DOType
     for (xmlNode* ln = templates->children; ln; ln = ln->next) {
         if (ln->type != XML_ELEMENT_NODE) continue;
         if (xmlStrcmp(ln->name, (const xmlChar*)"LNodeType") != 0) continue;
 
-        xmlChar* lnClassAttr = xmlGetProp(ln, (const xmlChar*)"lnClass");
-        xmlChar* lnTypeAttr  = xmlGetProp(ln, (const xmlChar*)"id");
-        const char* lnClass = lnClassAttr ? (const char*)lnClassAttr : NULL;
-        const char* lnTypeId = lnTypeAttr ? (const char*)lnTypeAttr : NULL;
+        static const char* const lnTypeNames[] = { "id", "lnClass" };
+        const char* lnAttrs[2];
+        xml_attrs(doc, ln, lnTypeNames, lnAttrs, 2);
+        const char* lnTypeId = lnAttrs[0];
+        const char* lnClass = lnAttrs[1];
+        if (lnTypes && !str_index_find(lnTypes, lnTypeId, NULL)) {
+            doc->parse_stats.lnTypesSkipped++;
+            continue;
+        }
 
         for (xmlNode* doNode = ln->children; doNode; doNode = doNode->next) {
             if (doNode->type != XML_ELEMENT_NODE || xmlStrcmp(doNode->name, (const xmlChar*)"DO") != 0) continue;
-            xmlChar* doNameAttr = xmlGetProp(doNode, (const xmlChar*)"name");
-            xmlChar* doTypeAttr = xmlGetProp(doNode, (const xmlChar*)"type");
-
-            const char* doName = doNameAttr ? (const char*)doNameAttr : NULL;
-            const char* doType = doTypeAttr ? (const char*)doTypeAttr : NULL;
+            const char* doAttrs[2];
+            xml_attrs(doc, doNode, name_type_attr_names, doAttrs, 2);
+            const char* doName = doAttrs[0];
+            const char* doType = doAttrs[1];
 
             // Look up the DOType to determine the CDC
-            xmlNode* doTypeNode = find_node(templates->children, "DOType", "id", doType);
-            if (!doTypeNode) continue;
-            xmlChar* cdcAttr = xmlGetProp(doTypeNode, (const xmlChar*)"cdc");
-            const char* cdc = cdcAttr ? (const char*)cdcAttr : NULL;
-
-            DOEntry* e = calloc(1, sizeof(DOEntry));
-            if (lnTypeId)
-                strncpy(e->lnType, lnTypeId, sizeof(e->lnType)-1);
-            if (lnClass)
-                strncpy(e->lnClass, lnClass, sizeof(e->lnClass)-1);
-            if (doName)
-                strncpy(e->doName, doName, sizeof(e->doName)-1);
-            if (doType)
-                strncpy(e->doType, doType, sizeof(e->doType)-1);
-            if (cdc)
-                strncpy(e->cdc, cdc, sizeof(e->cdc)-1);
-            e->next = do_list;
-            do_list = e;
-
-            collect_do_type(templates, doType, NULL);
-
-            if (cdcAttr) xmlFree(cdcAttr);
-            if (doNameAttr) xmlFree(doNameAttr);
-            if (doTypeAttr) xmlFree(doTypeAttr);
+            xmlNode* doTypeNode = find_template(doc, TEMPLATE_DOTYPE, doType);
+            if (!doTypeNode)
+                continue;
+            const char* cdc = xml_attr(doc, doTypeNode, "cdc");
+
+            DOEntry* items = arena_array_reserve(&doc->template_arena, doc->do_table, doc->do_count,
+                                                 &doc->do_capacity, sizeof(DOEntry));
+            if (!items)
+                continue;
+            doc->do_table = items;
+
+            DOEntry* e = &doc->do_table[doc->do_count++];
+            e->lnType = sym_intern(doc, lnTypeId);
+            e->lnClass = sym_intern(doc, lnClass);
+            e->doName = sym_intern(doc, doName);
+            e->doType = sym_intern(doc, doType);
+            e->cdc = sym_intern(doc, cdc);
+            e->cdcCode = (uint8_t)decode_cdc(cdc);
+
+            collect_do_type(doc, doType, NULL);
         }
+    }
+
+    doc->parse_stats.doTypesSkipped = count_unreached_templates(doc, TEMPLATE_DOTYPE);
+    doc->parse_stats.daTypesSkipped = count_unreached_templates(doc, TEMPLATE_DATYPE);
+
+    expansion_cache_free(doc);
+    template_index_free(doc);  // indexed nodes die with the document
+}
 
-        if (lnClassAttr) xmlFree(lnClassAttr);
-        if (lnTypeAttr) xmlFree(lnTypeAttr);
+/* Only the LN types the loaded IEDs instantiate are ever built, so expand just those */
+static void expand_instantiated_templates(IcdDocument* doc, xmlNode* templates)
+{
+    StrIndex lnTypes;
+    str_index_init(&lnTypes, 64);
+    for (size_t k = 0; k < doc->ied_count; ++k) {
+        const IedTables* ied = &doc->ieds[k];
+        for (size_t i = 0; i < ied->ln_inst_count; ++i)
+            str_index_insert(&lnTypes, sym_str(doc, ied->ln_inst_table[i].lnType), 0);
     }
+    expand_templates(doc, templates, &lnTypes);
+    str_index_free(&lnTypes);
+}
 
-    xmlNode* activeIed = find_active_ied(root);
-    if (!activeIed) {
-        fprintf(stderr, "No IED definition found in SCL file.\n");
-        return;
+static void parse_icd(IcdDocument* doc, xmlDocPtr xml) {
+    xmlNode* root = xmlDocGetRootElement(xml);
+    xmlNode* templates = find_node(doc, root->children, "DataTypeTemplates", NULL, NULL);
+    if (!templates) return;
+
+    if (doc->all_ieds) {
+        collect_all_ieds(doc, root);
+        if (doc->ied_count == 0)
+            fprintf(stderr, "No IED definition found in SCL file.\n");
+    }
+    else {
+        xmlNode* activeIed = find_active_ied(doc, root);
+        if (!activeIed)
+            fprintf(stderr, "No IED definition found in SCL file.\n");
+        else if (begin_ied(doc, doc->selected_ied_name))
+            collect_ied(doc, activeIed, doc->selected_ap_name);
     }
 
-    collect_ln_nodes(activeIed);
-    collect_dataset_nodes(activeIed);
+    expand_instantiated_templates(doc, templates);
 }
 
-bool icd_load(const char* path) {
-    icd_unload();
-    xmlInitParser();
-    xmlDoc* doc = xmlReadFile(path, NULL, 0);
-    if (!doc) return false;
-    parse_icd(doc);
-    xmlFreeDoc(doc);
+static void print_parse_summary(IcdDocument* doc)
+{
+    doc->parse_stats.arenaBytes = doc->template_arena.bytesReserved + doc->ied_arena.bytesReserved;
+    doc->parse_stats.arenaChunks = doc->template_arena.chunkCount + doc->ied_arena.chunkCount;
+    doc->parse_stats.symbolCount = doc->symbols.count;
+    doc->parse_stats.symbolBytes = doc->symbols.keysUsed;
+    fprintf(stdout, "ICD parse summary: templates=%zu template-lookups=%zu misses=%zu "
+            "DOType expanded=%zu reused=%zu DAType expanded=%zu reused=%zu "
+            "arena=%zu KiB in %zu chunks attributes read=%zu copied=%zu symbols=%zu (%zu KiB)\n",
+            doc->parse_stats.templateCount, doc->parse_stats.templateLookups, doc->parse_stats.templateMisses,
+            doc->parse_stats.doTypeExpansions, doc->parse_stats.doTypeReuses,
+            doc->parse_stats.daTypeExpansions, doc->parse_stats.daTypeReuses,
+            doc->parse_stats.arenaBytes / 1024, doc->parse_stats.arenaChunks,
+            doc->parse_stats.attrReads, doc->parse_stats.attrCopies,
+            doc->parse_stats.symbolCount, doc->parse_stats.symbolBytes / 1024);
+    char scope[80];
+    if (doc->all_ieds)
+        snprintf(scope, sizeof(scope), "%zu IEDs", doc->ied_count);
+    else
+        snprintf(scope, sizeof(scope), "'%s'", doc->selected_ied_name);
+    fprintf(stdout, "ICD templates skipped (not instantiated by %s): LNodeType=%zu DOType=%zu DAType=%zu\n",
+            scope, doc->parse_stats.lnTypesSkipped,
+            doc->parse_stats.doTypesSkipped, doc->parse_stats.daTypesSkipped);
+}
+
+static bool load_dom(IcdDocument* doc, const char* path)
+{
+    xmlDoc* xml = xmlReadFile(path, NULL, 0);
+    if (!xml) return false;
+    parse_icd(doc, xml);
+    xmlFreeDoc(xml);
     return true;
 }
 
-bool icd_find_do_info(const char* lnTypeId, const char* do_name, DOInfo* out) {
-    if (!lnTypeId || !do_name || !out)
+/* ---------- Streaming (xmlTextReader) parse path ---------- */
+
+typedef struct {
+    char iedName[64];       // IED to collect, empty = first named IED
+    char apName[64];        // AccessPoint to collect, empty = first one
+    int apOrdinal;          // >= 0: collect the AccessPoint at this position instead
+    char firstIed[64];
+    char firstAp[64];       // first AccessPoint of the collected IED
+    int apCount;
+    bool iedFound;
+    bool apFound;
+    bool allIeds;           // collect every named IED, apName is then only a preference
+    xmlDoc* templatesDoc;   // detached copy of DataTypeTemplates
+} StreamPass;
+
+static bool reader_name_is(const char* name, const char* expected)
+{
+    return name && strcmp(name, expected) == 0;
+}
+
+static void stream_keep_templates(xmlTextReaderPtr reader, StreamPass* pass)
+{
+    xmlNode* node = xmlTextReaderExpand(reader);
+    if (!node)
+        return;
+    xmlDoc* xml = xmlNewDoc((const xmlChar*)"1.0");
+    xmlNode* copy = xml ? xmlDocCopyNode(node, xml, 1) : NULL;
+    if (!copy) {
+        if (xml) xmlFreeDoc(xml);
+        return;
+    }
+    xmlDocSetRootElement(xml, copy);
+    pass->templatesDoc = xml;
+}
+
+/*
+ * One forward pass over the file. Only the selected IED (or, with allIeds,
+ * each named IED in turn) is descended into,
+ * each LN/LN0 is expanded on its own and released once the reader moves on,
+ * and DataTypeTemplates is copied out for expansion after the pass.
+ */
+static bool stream_pass(IcdDocument* doc, const char* path, StreamPass* pass)
+{
+    xmlTextReaderPtr reader = xmlReaderForFile(path, NULL, 0);
+    if (!reader)
         return false;
 
-    for (DOEntry* e = do_list; e; e = e->next) {
-        if (!strcmp(e->lnType, lnTypeId) && !strcmp(e->doName, do_name)) {
-            snprintf(out->do_type_id, sizeof(out->do_type_id), "%s", e->doType);
-            snprintf(out->cdc, sizeof(out->cdc), "%s", e->cdc);
-            return true;
+    int iedDepth = -1;
+    int apDepth = -1;
+    int serverDepth = -1;
+    char ldInst[64] = "";
+    bool inLd = false;
+
+    int ret = xmlTextReaderRead(reader);
+    while (ret == 1) {
+        if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) {
+            ret = xmlTextReaderRead(reader);
+            continue;
+        }
+
+        const char* name = (const char*)xmlTextReaderConstLocalName(reader);
+        int depth = xmlTextReaderDepth(reader);
+
+        if (depth == 1) {
+            iedDepth = apDepth = serverDepth = -1;
+            inLd = false;
+            if (reader_name_is(name, "IED")) {
+                xmlChar* nameAttr = xmlTextReaderGetAttribute(reader, (const xmlChar*)"name");
+                const char* iedName = nameAttr ? (const char*)nameAttr : "";
+                if (!pass->firstIed[0] && *iedName)
+                    snprintf(pass->firstIed, sizeof(pass->firstIed), "%s", iedName);
+                bool wanted;
+                if (pass->allIeds) {
+                    wanted = begin_ied(doc, iedName);
+                    pass->apCount = 0;
+                    pass->apFound = false;
+                }
+                else {
+                    wanted = !pass->iedFound && *iedName &&
+                             (!pass->iedName[0] || strcmp(pass->iedName, iedName) == 0) &&
+                             begin_ied(doc, iedName);
+                    if (wanted)
+                        snprintf(pass->iedName, sizeof(pass->iedName), "%s", iedName);
+                }
+                if (wanted) {
+                    pass->iedFound = true;
+                    iedDepth = depth;
+                }
+                if (nameAttr) xmlFree(nameAttr);
+                if (wanted) {
+                    ret = xmlTextReaderRead(reader);
+                    continue;
+                }
+            }
+            else if (reader_name_is(name, "DataTypeTemplates") && !pass->templatesDoc) {
+                stream_keep_templates(reader, pass);
+            }
+            ret = xmlTextReaderNext(reader);
+            continue;
         }
+
+        if (iedDepth >= 0) {
+            if (depth == iedDepth + 1) {
+                apDepth = serverDepth = -1;
+                inLd = false;
+            }
+            else if (apDepth >= 0 && depth == apDepth + 1) {
+                serverDepth = reader_name_is(name, "Server") ? depth : -1;
+                inLd = false;
+            }
+
+            if (depth == iedDepth + 1 && reader_name_is(name, "AccessPoint")) {
+                xmlChar* apAttr = xmlTextReaderGetAttribute(reader, (const xmlChar*)"name");
+                const char* apName = apAttr ? (const char*)apAttr : "";
+                int ordinal = pass->apCount++;
+                if (ordinal == 0)
+                    snprintf(pass->firstAp, sizeof(pass->firstAp), "%s", apName);
+                bool requestedMatch = !pass->apName[0] || strcmp(pass->apName, apName) == 0;
+                bool wanted;
+                if (pass->allIeds) {
+                    // The first AccessPoint is kept until one matching the preference shows up
+                    wanted = !pass->apFound && (ordinal == 0 || requestedMatch);
+                    if (wanted && ordinal > 0)
+                        reset_ied_access_point(doc);
+                    pass->apFound = wanted && requestedMatch;
+                }
+                else {
+                    wanted = !pass->apFound &&
+                             (pass->apOrdinal >= 0 ? ordinal == pass->apOrdinal : requestedMatch);
+                    if (wanted) {
+                        pass->apFound = true;
+                        snprintf(pass->apName, sizeof(pass->apName), "%s", apName);
+                    }
+                }
+                if (wanted) {
+                    IedTables* ied = current_ied(doc);
+                    snprintf(ied->accessPoint, sizeof(ied->accessPoint), "%s", apName);
+                    apDepth = depth;
+                }
+                if (apAttr) xmlFree(apAttr);
+            }
+            else if (serverDepth >= 0 && depth == serverDepth + 1) {
+                inLd = reader_name_is(name, "LDevice");
+                if (inLd) {
+                    xmlChar* instAttr = xmlTextReaderGetAttribute(reader, (const xmlChar*)"inst");
+                    snprintf(ldInst, sizeof(ldInst), "%s", instAttr ? (const char*)instAttr : "");
+                    if (instAttr) xmlFree(instAttr);
+                }
+            }
+            else if (reader_name_is(name, "LN") || reader_name_is(name, "LN0")) {
+                xmlNode* lnNode = xmlTextReaderExpand(reader);
+                if (lnNode) {
+                    register_ln_class(doc, lnNode);
+                    if (inLd && depth == serverDepth + 2)
+                        process_ln_for_datasets(doc, lnNode, ldInst);
+                }
+                ret = xmlTextReaderNext(reader);
+                continue;
+            }
+        }
+
+        ret = xmlTextReaderRead(reader);
     }
-    return false;
+
+    xmlFreeTextReader(reader);
+    return ret == 0;
 }
 
-bool icd_find_da_info(const char* do_type_id, const char* da_path, DAInfo* out) {
-    for (DAEntry* e = da_list; e; e = e->next) {
-        if (!strcmp(e->doType, do_type_id) && !strcmp(e->daPath, da_path)) {
-            strncpy(out->fc, e->fc, sizeof(out->fc));
-            strncpy(out->bType, e->bType, sizeof(out->bType));
-            strncpy(out->typeId, e->typeId, sizeof(out->typeId));
-            out->trgOps = e->trgOps;
-            return true;
+static void free_ied_tables(IcdDocument* doc);
+static void release_tables(IcdDocument* doc);
+
+static bool load_stream(IcdDocument* doc, const char* path)
+{
+    StreamPass pass;
+    memset(&pass, 0, sizeof(pass));
+    snprintf(pass.iedName, sizeof(pass.iedName), "%s", doc->selected_ied_name);
+    snprintf(pass.apName, sizeof(pass.apName), "%s", doc->selected_ap_name);
+    pass.apOrdinal = -1;
+    pass.allIeds = doc->all_ieds;
+    if (!stream_pass(doc, path, &pass)) {
+        if (pass.templatesDoc)
+            xmlFreeDoc(pass.templatesDoc);
+        return false;
+    }
+
+    // The requested IED or AccessPoint was missing: collect the first ones
+    // in a second pass, as the DOM path falls back to them
+    bool iedFallback = !pass.allIeds && !pass.iedFound && pass.firstIed[0];
+    bool apFallback = !pass.allIeds && pass.iedFound && !pass.apFound && pass.apCount > 0;
+    if (iedFallback || apFallback) {
+        if (iedFallback && doc->selected_ied_name[0])
+            fprintf(stderr, "Requested IED '%s' not found. Using '%s'.\n", doc->selected_ied_name, pass.firstIed);
+        if (apFallback)
+            fprintf(stderr, "Requested AccessPoint '%s' not found. Using '%s'.\n", pass.apName,
+                    pass.firstAp[0] ? pass.firstAp : "<unnamed>");
+
+        StreamPass retry;
+        memset(&retry, 0, sizeof(retry));
+        snprintf(retry.iedName, sizeof(retry.iedName), "%s", iedFallback ? pass.firstIed : pass.iedName);
+        retry.apOrdinal = 0;
+        retry.templatesDoc = pass.templatesDoc;
+        free_ied_tables(doc);
+        if (!stream_pass(doc, path, &retry)) {
+            if (retry.templatesDoc)
+                xmlFreeDoc(retry.templatesDoc);
+            return false;
         }
+        pass = retry;
     }
-    return false;
+    else if (pass.allIeds) {
+        for (size_t i = 0; pass.apName[0] && i < doc->ied_count; ++i) {
+            const IedTables* ied = &doc->ieds[i];
+            if (strcmp(ied->accessPoint, pass.apName) != 0)
+                fprintf(stderr, "Requested AccessPoint '%s' not found in IED '%s'. Using '%s'.\n", pass.apName,
+                        ied->name, ied->accessPoint[0] ? ied->accessPoint : "<unnamed>");
+        }
+    }
+    else if (!pass.iedFound && doc->selected_ied_name[0]) {
+        fprintf(stderr, "Requested IED '%s' not found in SCL file.\n", doc->selected_ied_name);
+    }
+    else if (pass.iedFound && !pass.apFound && pass.apName[0]) {
+        fprintf(stderr, "Requested AccessPoint '%s' not found in IED '%s'.\n", pass.apName, pass.iedName);
+        pass.apName[0] = '\0';
+    }
+
+    if (pass.allIeds) {
+        select_default_ied(doc, doc->selected_ied_name);
+    }
+    else {
+        snprintf(doc->selected_ied_name, sizeof(doc->selected_ied_name), "%s", pass.iedFound ? pass.iedName : "");
+        snprintf(doc->selected_ap_name, sizeof(doc->selected_ap_name), "%s", pass.apFound ? pass.apName : "");
+        IedTables* ied = current_ied(doc);
+        if (ied)
+            snprintf(ied->accessPoint, sizeof(ied->accessPoint), "%s", doc->selected_ap_name);
+    }
+
+    if (!pass.templatesDoc) {
+        // Same outcome as the DOM path, which ignores IEDs without templates
+        free_ied_tables(doc);
+        return true;
+    }
+
+    expand_instantiated_templates(doc, xmlDocGetRootElement(pass.templatesDoc));
+    xmlFreeDoc(pass.templatesDoc);
+
+    if (!pass.iedFound)
+        fprintf(stderr, "No IED definition found in SCL file.\n");
+    return true;
+}
+
+/* ---------- Binary table cache ---------- */
+
+/*
+ * The cache is the parsed tables written out as-is, so a warm start maps the
+ * file and points the tables into it instead of touching the XML. Indexes
+ * are copied out of the mapping because StrIndex owns its arrays.
+ */
+
+#define MODEL_CACHE_MAGIC "ICDCACHE"
+#define MODEL_CACHE_VERSION 5u
+#define MODEL_CACHE_ALIGN 16
+
+enum {
+    CACHE_DO_TABLE,
+    CACHE_DA_TABLES,
+    CACHE_DA_ITEMS,
+    CACHE_DA_TYPE_INDEX,                          // slots, entries, keys
+    CACHE_DA_PATH_INDEX = CACHE_DA_TYPE_INDEX + 3,
+    CACHE_SYMBOLS = CACHE_DA_PATH_INDEX + 3,        // the interned identifiers every table refers to
+    CACHE_IED_DIRECTORY = CACHE_SYMBOLS + 3,        // one CacheIed per IED
+    CACHE_SECTION_COUNT
+};
+
+/* Sections written once per IED */
+enum {
+    CACHE_LN_TABLE,
+    CACHE_LN_NAME_INDEX,
+    CACHE_LN_INST_TABLE = CACHE_LN_NAME_INDEX + 3,
+    CACHE_LN_INST_NAME_INDEX,
+    CACHE_LN_INST_PARTS_INDEX = CACHE_LN_INST_NAME_INDEX + 3,
+    CACHE_DATASET_TABLE = CACHE_LN_INST_PARTS_INDEX + 3,
+    CACHE_DATASET_INDEX,
+    CACHE_FCDA_TABLE = CACHE_DATASET_INDEX + 3,
+    CACHE_REPORT_TABLE,
+    CACHE_IED_SECTION_COUNT
+};
+
+typedef struct {
+    uint64_t offset;
+    uint64_t count;   // items of the section type
+} CacheSection;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t allIeds;        // written by an --all-ieds load
+    uint64_t layoutId;       // struct sizes of the build that wrote the file
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    char requestedIed[64];   // --ied/--ap the tables were built for
+    char requestedAp[64];
+    char selectedIed[64];    // what the parser ended up selecting
+    char selectedAp[64];
+    uint64_t defaultIed;     // position in CACHE_IED_DIRECTORY
+    CacheSection sections[CACHE_SECTION_COUNT];
+} CacheHeader;
+
+typedef struct {
+    char name[64];
+    char accessPoint[64];
+    CacheSection sections[CACHE_IED_SECTION_COUNT];
+} CacheIed;
+
+typedef struct {
+    Sym doType;
+    uint32_t reserved;
+    uint64_t first;   // position in CACHE_DA_ITEMS
+    uint64_t count;
+} CacheDaTable;
+
+static uint64_t hash_mix(uint64_t h, uint64_t v)
+{
+    h ^= v;
+    h *= 0x100000001b3ull;  // FNV-1a prime, applied per word
+    return h ^ (h >> 29);
+}
+
+static uint64_t model_cache_layout_id(void)
+{
+    const size_t sizes[] = {
+        sizeof(DOEntry), sizeof(DAEntry), sizeof(LNEntry), sizeof(LNInstEntry), sizeof(FcdaEntry),
+        sizeof(DataSetEntryDef), sizeof(ReportEntry), sizeof(StrIndexEntry), sizeof(CacheHeader), sizeof(CacheIed)
+    };
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+        h = hash_mix(h, sizes[i]);
+    return h;
+}
+
+static bool hash_source_file(const char* path, uint64_t* hash, uint64_t* size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    uint64_t h = 0xcbf29ce484222325ull;
+    size_t len = (size_t)st.st_size;
+    if (len > 0) {
+        const unsigned char* data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8) {
+            uint64_t w;
+            memcpy(&w, data + i, 8);
+            h = hash_mix(h, w);
+        }
+        for (; i < len; ++i)
+            h = hash_mix(h, data[i]);
+        munmap((void*)data, len);
+    }
+    close(fd);
+
+    *hash = hash_mix(h, len);
+    *size = len;
+    return true;
+}
+
+static void cache_key_name(char out[64], const char* name)
+{
+    memset(out, 0, 64);
+    if (name)
+        snprintf(out, 64, "%s", name);
+}
+
+/* Called before parsing, while the selection still holds what the caller asked for */
+static bool model_cache_key(const IcdDocument* doc, const char* path, CacheHeader* key)
+{
+    memset(key, 0, sizeof(*key));
+    key->version = MODEL_CACHE_VERSION;
+    key->layoutId = model_cache_layout_id();
+    key->allIeds = doc->all_ieds;
+    cache_key_name(key->requestedIed, doc->selected_ied_name);
+    cache_key_name(key->requestedAp, doc->selected_ap_name);
+    return hash_source_file(path, &key->sourceHash, &key->sourceSize);
+}
+
+static bool cache_write_section(FILE* fp, CacheSection* sec, const void* data, size_t itemSize, size_t count)
+{
+    static const char pad[MODEL_CACHE_ALIGN] = {0};
+    long pos = ftell(fp);
+    if (pos < 0)
+        return false;
+    size_t padLen = (MODEL_CACHE_ALIGN - (size_t)pos % MODEL_CACHE_ALIGN) % MODEL_CACHE_ALIGN;
+    if (padLen && fwrite(pad, 1, padLen, fp) != padLen)
+        return false;
+    sec->offset = (uint64_t)pos + padLen;
+    sec->count = count;
+    return count == 0 || fwrite(data, itemSize, count, fp) == count;
+}
+
+static bool cache_write_index(FILE* fp, CacheSection* sec, const StrIndex* idx)
+{
+    return cache_write_section(fp, &sec[0], idx->slots, sizeof(uint32_t), idx->slots ? idx->slotCount : 0) &&
+           cache_write_section(fp, &sec[1], idx->entries, sizeof(StrIndexEntry), idx->count) &&
+           cache_write_section(fp, &sec[2], idx->keys, 1, idx->keysUsed);
+}
+
+static bool cache_write_ied(FILE* fp, CacheIed* entry, const IedTables* ied)
+{
+    CacheSection* sec = entry->sections;
+    memcpy(entry->name, ied->name, sizeof(entry->name));
+    memcpy(entry->accessPoint, ied->accessPoint, sizeof(entry->accessPoint));
+    return cache_write_section(fp, &sec[CACHE_LN_TABLE], ied->ln_table, sizeof(LNEntry), ied->ln_count) &&
+           cache_write_index(fp, &sec[CACHE_LN_NAME_INDEX], &ied->ln_name_index) &&
+           cache_write_section(fp, &sec[CACHE_LN_INST_TABLE], ied->ln_inst_table, sizeof(LNInstEntry),
+                               ied->ln_inst_count) &&
+           cache_write_index(fp, &sec[CACHE_LN_INST_NAME_INDEX], &ied->ln_inst_name_index) &&
+           cache_write_index(fp, &sec[CACHE_LN_INST_PARTS_INDEX], &ied->ln_inst_parts_index) &&
+           cache_write_section(fp, &sec[CACHE_DATASET_TABLE], ied->dataset_table, sizeof(DataSetEntryDef),
+                               ied->dataset_count) &&
+           cache_write_index(fp, &sec[CACHE_DATASET_INDEX], &ied->dataset_index) &&
+           cache_write_section(fp, &sec[CACHE_FCDA_TABLE], ied->fcda_table, sizeof(FcdaEntry), ied->fcda_count) &&
+           cache_write_section(fp, &sec[CACHE_REPORT_TABLE], ied->report_table, sizeof(ReportEntry),
+                               ied->report_count);
+}
+
+static bool model_cache_store(const IcdDocument* doc, const char* cachePath, const CacheHeader* key)
+{
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", cachePath);
+    FILE* fp = fopen(tmpPath, "wb");
+    if (!fp)
+        return false;
+
+    CacheHeader hdr = *key;
+    cache_key_name(hdr.selectedIed, doc->selected_ied_name);
+    cache_key_name(hdr.selectedAp, doc->selected_ap_name);
+    hdr.defaultIed = doc->default_ied;
+
+    CacheIed* iedDir = calloc(doc->ied_count ? doc->ied_count : 1, sizeof(CacheIed));
+    CacheDaTable* daTables = calloc(doc->da_table_count ? doc->da_table_count : 1, sizeof(CacheDaTable));
+    size_t daItems = 0;
+    for (size_t i = 0; daTables && i < doc->da_table_count; ++i) {
+        daTables[i].doType = doc->da_tables[i].doType;
+        daTables[i].first = daItems;
+        daTables[i].count = doc->da_tables[i].count;
+        daItems += doc->da_tables[i].count;
+    }
+
+    bool ok = iedDir && daTables && fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    CacheSection* sec = hdr.sections;
+    ok = ok && cache_write_section(fp, &sec[CACHE_DO_TABLE], doc->do_table, sizeof(DOEntry), doc->do_count);
+    ok = ok && cache_write_section(fp, &sec[CACHE_DA_TABLES], daTables, sizeof(CacheDaTable), doc->da_table_count);
+    ok = ok && cache_write_section(fp, &sec[CACHE_DA_ITEMS], NULL, sizeof(DAEntry), 0);
+    sec[CACHE_DA_ITEMS].count = daItems;
+    for (size_t i = 0; ok && i < doc->da_table_count; ++i) {
+        const DaTypeTable* t = &doc->da_tables[i];
+        ok = t->count == 0 || fwrite(t->items, sizeof(DAEntry), t->count, fp) == t->count;
+    }
+    ok = ok && cache_write_index(fp, &sec[CACHE_DA_TYPE_INDEX], &doc->da_type_index);
+    ok = ok && cache_write_index(fp, &sec[CACHE_DA_PATH_INDEX], &doc->da_path_index);
+    ok = ok && cache_write_index(fp, &sec[CACHE_SYMBOLS], &doc->symbols);
+    for (size_t i = 0; ok && i < doc->ied_count; ++i)
+        ok = cache_write_ied(fp, &iedDir[i], &doc->ieds[i]);
+    ok = ok && cache_write_section(fp, &sec[CACHE_IED_DIRECTORY], iedDir, sizeof(CacheIed), doc->ied_count);
+    free(daTables);
+    free(iedDir);
+
+    // Header last, so a file that was cut short never carries a valid one
+    memcpy(hdr.magic, MODEL_CACHE_MAGIC, sizeof(hdr.magic));
+    ok = ok && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmpPath, cachePath) != 0) {
+        remove(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+static const void* cache_section_data(const unsigned char* base, size_t size, const CacheSection* sec,
+                                      size_t itemSize)
+{
+    if (sec->offset % MODEL_CACHE_ALIGN != 0 || sec->offset > size)
+        return NULL;
+    if (sec->count > (size - sec->offset) / itemSize)
+        return NULL;
+    return base + sec->offset;
+}
+
+static bool cache_restore_index(const unsigned char* base, size_t size, const CacheSection* sec, StrIndex* idx)
+{
+    const uint32_t* slots = cache_section_data(base, size, &sec[0], sizeof(uint32_t));
+    const StrIndexEntry* entries = cache_section_data(base, size, &sec[1], sizeof(StrIndexEntry));
+    const char* keys = cache_section_data(base, size, &sec[2], 1);
+    if (!slots || !entries || !keys)
+        return false;
+    if (sec[0].count == 0)
+        return sec[1].count == 0;  // index never used
+    return str_index_restore(idx, slots, sec[0].count, entries, sec[1].count, keys, sec[2].count);
+}
+
+static bool cache_load_ied(const unsigned char* base, size_t size, const CacheIed* entry, IedTables* ied)
+{
+    const CacheSection* sec = entry->sections;
+    memcpy(ied->name, entry->name, sizeof(ied->name));
+    memcpy(ied->accessPoint, entry->accessPoint, sizeof(ied->accessPoint));
+    ied->name[sizeof(ied->name) - 1] = '\0';
+    ied->accessPoint[sizeof(ied->accessPoint) - 1] = '\0';
+    ied->ln_table = (LNEntry*)cache_section_data(base, size, &sec[CACHE_LN_TABLE], sizeof(LNEntry));
+    ied->ln_inst_table = (LNInstEntry*)cache_section_data(base, size, &sec[CACHE_LN_INST_TABLE],
+                                                          sizeof(LNInstEntry));
+    ied->dataset_table = (DataSetEntryDef*)cache_section_data(base, size, &sec[CACHE_DATASET_TABLE],
+                                                              sizeof(DataSetEntryDef));
+    ied->fcda_table = (FcdaEntry*)cache_section_data(base, size, &sec[CACHE_FCDA_TABLE], sizeof(FcdaEntry));
+    ied->report_table = (ReportEntry*)cache_section_data(base, size, &sec[CACHE_REPORT_TABLE],
+                                                         sizeof(ReportEntry));
+    if (!ied->ln_table || !ied->ln_inst_table || !ied->dataset_table || !ied->fcda_table || !ied->report_table)
+        return false;
+
+    ied->ln_count = ied->ln_capacity = sec[CACHE_LN_TABLE].count;
+    ied->ln_inst_count = ied->ln_inst_capacity = sec[CACHE_LN_INST_TABLE].count;
+    ied->dataset_count = ied->dataset_capacity = sec[CACHE_DATASET_TABLE].count;
+    ied->fcda_count = ied->fcda_capacity = sec[CACHE_FCDA_TABLE].count;
+    ied->report_count = ied->report_capacity = sec[CACHE_REPORT_TABLE].count;
+    for (size_t i = 0; i < ied->dataset_count; ++i) {
+        const DataSetEntryDef* ds = &ied->dataset_table[i];
+        if (ds->firstMember > ied->fcda_count || ds->memberCount > ied->fcda_count - ds->firstMember)
+            return false;
+    }
+    return cache_restore_index(base, size, &sec[CACHE_LN_NAME_INDEX], &ied->ln_name_index) &&
+           cache_restore_index(base, size, &sec[CACHE_LN_INST_NAME_INDEX], &ied->ln_inst_name_index) &&
+           cache_restore_index(base, size, &sec[CACHE_LN_INST_PARTS_INDEX], &ied->ln_inst_parts_index) &&
+           cache_restore_index(base, size, &sec[CACHE_DATASET_INDEX], &ied->dataset_index);
+}
+
+/* Point the document tables into a mapped cache. False if the file is missing, stale or damaged. */
+static bool model_cache_load(IcdDocument* doc, const char* cachePath, const CacheHeader* key)
+{
+    int fd = open(cachePath, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    unsigned char* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+
+    CacheHeader hdr;
+    memcpy(&hdr, base, sizeof(hdr));
+    if (memcmp(hdr.magic, MODEL_CACHE_MAGIC, sizeof(hdr.magic)) != 0 || hdr.version != key->version ||
+        hdr.allIeds != key->allIeds ||
+        hdr.layoutId != key->layoutId || hdr.sourceHash != key->sourceHash ||
+        hdr.sourceSize != key->sourceSize || memcmp(hdr.requestedIed, key->requestedIed, 64) != 0 ||
+        memcmp(hdr.requestedAp, key->requestedAp, 64) != 0) {
+        munmap(base, size);
+        return false;
+    }
+
+    const CacheSection* sec = hdr.sections;
+    const CacheDaTable* daTables = cache_section_data(base, size, &sec[CACHE_DA_TABLES], sizeof(CacheDaTable));
+    DAEntry* daItems = (DAEntry*)cache_section_data(base, size, &sec[CACHE_DA_ITEMS], sizeof(DAEntry));
+    const CacheIed* iedDir = cache_section_data(base, size, &sec[CACHE_IED_DIRECTORY], sizeof(CacheIed));
+    doc->do_table = (DOEntry*)cache_section_data(base, size, &sec[CACHE_DO_TABLE], sizeof(DOEntry));
+    doc->model_cache_map = base;
+    doc->model_cache_size = size;
+
+    bool ok = daTables && daItems && iedDir && doc->do_table;
+    if (ok)
+        doc->do_count = doc->do_capacity = sec[CACHE_DO_TABLE].count;
+
+    size_t tableCount = ok ? sec[CACHE_DA_TABLES].count : 0;
+    if (tableCount) {
+        doc->da_tables = arena_alloc(&doc->template_arena, tableCount * sizeof(DaTypeTable));
+        ok = doc->da_tables != NULL;
+    }
+    for (size_t i = 0; ok && i < tableCount; ++i) {
+        const CacheDaTable* t = &daTables[i];
+        ok = t->first <= sec[CACHE_DA_ITEMS].count && t->count <= sec[CACHE_DA_ITEMS].count - t->first;
+        if (!ok)
+            break;
+        DaTypeTable* table = &doc->da_tables[i];
+        table->doType = t->doType;
+        table->items = daItems + t->first;
+        table->count = table->capacity = (size_t)t->count;
+    }
+    doc->da_table_count = doc->da_table_capacity = tableCount;
+
+    ok = ok && cache_restore_index(base, size, &sec[CACHE_DA_TYPE_INDEX], &doc->da_type_index);
+    ok = ok && cache_restore_index(base, size, &sec[CACHE_DA_PATH_INDEX], &doc->da_path_index);
+    ok = ok && cache_restore_index(base, size, &sec[CACHE_SYMBOLS], &doc->symbols);
+
+    size_t iedCount = ok ? sec[CACHE_IED_DIRECTORY].count : 0;
+    if (iedCount) {
+        doc->ieds = arena_alloc(&doc->ied_arena, iedCount * sizeof(IedTables));
+        ok = doc->ieds != NULL;
+    }
+    for (size_t i = 0; ok && i < iedCount; ++i) {
+        IedTables* ied = &doc->ieds[i];
+        memset(ied, 0, sizeof(*ied));
+        doc->ied_count = doc->ied_capacity = i + 1;
+        ok = cache_load_ied(base, size, &iedDir[i], ied) && str_index_insert(&doc->ied_index, ied->name, (uint32_t)i);
+    }
+    ok = ok && (iedCount == 0 || hdr.defaultIed < iedCount);
+    if (!ok) {
+        release_tables(doc);
+        return false;
+    }
+
+    memcpy(doc->selected_ied_name, hdr.selectedIed, sizeof(doc->selected_ied_name));
+    memcpy(doc->selected_ap_name, hdr.selectedAp, sizeof(doc->selected_ap_name));
+    doc->selected_ied_name[sizeof(doc->selected_ied_name) - 1] = '\0';
+    doc->selected_ap_name[sizeof(doc->selected_ap_name) - 1] = '\0';
+    doc->default_ied = (size_t)hdr.defaultIed;
+    return true;
+}
+
+static pthread_once_t xml_init_once = PTHREAD_ONCE_INIT;
+
+static void xml_init(void)
+{
+    xmlInitParser();
+}
+
+IcdDocument* icd_load(const char* path, const IcdLoadOptions* options)
+{
+    if (!path)
+        return NULL;
+    pthread_once(&xml_init_once, xml_init);
+
+    IcdDocument* doc = calloc(1, sizeof(IcdDocument));
+    if (!doc)
+        return NULL;
+    doc->all_ieds = options && options->allIeds;
+    if (options && options->iedName && *options->iedName)
+        set_selected_ied(doc, options->iedName);
+    // With allIeds the AccessPoint is a preference applied to every IED
+    if (options && options->accessPoint && *options->accessPoint && (doc->selected_ied_name[0] || doc->all_ieds))
+        set_selected_ap(doc, options->accessPoint);
+
+    const char* cachePath = options ? options->cachePath : NULL;
+    CacheHeader cacheKey;
+    bool cacheable = cachePath && *cachePath && model_cache_key(doc, path, &cacheKey);
+    if (cacheable && model_cache_load(doc, cachePath, &cacheKey)) {
+        fprintf(stdout, "ICD cache hit: %s\n", cachePath);
+        return doc;
+    }
+
+    bool streaming = options && options->streaming;
+    if (!(streaming ? load_stream(doc, path) : load_dom(doc, path))) {
+        icd_unload(doc);
+        return NULL;
+    }
+
+    arena_release(&doc->scratch_arena);
+    print_parse_summary(doc);
+    if (cacheable) {
+        if (model_cache_store(doc, cachePath, &cacheKey))
+            fprintf(stdout, "ICD cache written: %s\n", cachePath);
+        else
+            fprintf(stderr, "Could not write ICD cache %s\n", cachePath);
+    }
+    return doc;
+}
+
+void icd_get_parse_stats(const IcdDocument* doc, IcdParseStats* out)
+{
+    if (doc && out)
+        *out = doc->parse_stats;
+}
+
+static void fill_da_info(const IcdDocument* doc, const DAEntry* e, DAInfo* out)
+{
+    out->fc = sym_str(doc, e->fc);
+    out->bType = sym_str(doc, e->bType);
+    out->typeId = sym_str(doc, e->typeId);
+    out->trgOps = e->trgOps;
+    out->bTypeCode = (IcdBType)e->bTypeCode;
+    out->fcCode = (IcdFc)e->fcCode;
 }
 
-bool icd_da_exists(const char* do_type_id, const char* da_path) {
-    for (DAEntry* e = da_list; e; e = e->next) {
-        if (!strcmp(e->doType, do_type_id) && !strcmp(e->daPath, da_path))
+bool icd_find_do_info(const IcdDocument* doc, const char* lnTypeId, const char* do_name, DOInfo* out) {
+    if (!doc || !lnTypeId || !do_name || !out)
+        return false;
+
+    Sym lnType = sym_find(doc, lnTypeId);
+    Sym doName = sym_find(doc, do_name);
+    if (lnType == SYM_NONE || doName == SYM_NONE)
+        return false;
+    for (size_t i = 0; i < doc->do_count; ++i) {
+        const DOEntry* e = &doc->do_table[i];
+        if (e->lnType == lnType && e->doName == doName) {
+            snprintf(out->do_type_id, sizeof(out->do_type_id), "%s", sym_str(doc, e->doType));
+            snprintf(out->cdc, sizeof(out->cdc), "%s", sym_str(doc, e->cdc));
+            out->cdcCode = (IcdCdc)e->cdcCode;
             return true;
+        }
     }
     return false;
 }
 
-void icd_foreach_da(const char* do_type_id,
+bool icd_find_da_info(const IcdDocument* doc, const char* do_type_id, const char* da_path, DAInfo* out) {
+    const DAEntry* e = doc ? find_da_entry(doc, do_type_id, da_path) : NULL;
+    if (!e || !out)
+        return false;
+    fill_da_info(doc, e, out);
+    return true;
+}
+
+bool icd_da_exists(const IcdDocument* doc, const char* do_type_id, const char* da_path) {
+    return doc && find_da_entry(doc, do_type_id, da_path) != NULL;
+}
+
+void icd_foreach_da(const IcdDocument* doc, const char* do_type_id,
                     void (*callback)(const char* path, const DAInfo* info, void* ctx),
                     void* ctx)
 {
-    if (!do_type_id || !callback)
+    if (!doc || !do_type_id || !callback)
         return;
 
-    for (DAEntry* e = da_list; e; e = e->next) {
-        if (strcmp(e->doType, do_type_id) != 0)
-            continue;
+    DaTypeTable* table = find_da_table(doc, do_type_id);
+    if (!table)
+        return;
 
+    for (size_t i = 0; i < table->count; ++i) {
+        const DAEntry* e = &table->items[i];
         DAInfo info = {0};
-        strncpy(info.fc, e->fc, sizeof(info.fc));
-        strncpy(info.bType, e->bType, sizeof(info.bType));
-        strncpy(info.typeId, e->typeId, sizeof(info.typeId));
-        info.trgOps = e->trgOps;
-        callback(e->daPath, &info, ctx);
+        fill_da_info(doc, e, &info);
+        callback(sym_str(doc, e->daPath), &info, ctx);
     }
 }
 
-void icd_foreach_do(const char* lnTypeId,
+void icd_foreach_do(const IcdDocument* doc, const char* lnTypeId,
                     void (*callback)(const char* doName, const DOInfo* info, void* ctx),
                     void* ctx)
 {
-    if (!lnTypeId || !callback)
+    if (!doc || !lnTypeId || !callback)
         return;
 
-    for (DOEntry* e = do_list; e; e = e->next) {
-        if (strcmp(e->lnType, lnTypeId) != 0)
+    Sym lnType = sym_find(doc, lnTypeId);
+    for (size_t i = 0; lnType != SYM_NONE && i < doc->do_count; ++i) {
+        const DOEntry* e = &doc->do_table[i];
+        if (e->lnType != lnType)
             continue;
 
         DOInfo info = {0};
-        snprintf(info.do_type_id, sizeof(info.do_type_id), "%s", e->doType);
-        snprintf(info.cdc, sizeof(info.cdc), "%s", e->cdc);
-        callback(e->doName, &info, ctx);
+        snprintf(info.do_type_id, sizeof(info.do_type_id), "%s", sym_str(doc, e->doType));
+        snprintf(info.cdc, sizeof(info.cdc), "%s", sym_str(doc, e->cdc));
+        info.cdcCode = (IcdCdc)e->cdcCode;
+        callback(sym_str(doc, e->doName), &info, ctx);
     }
 }
 
-void icd_foreach_ln_instance(void (*callback)(const LNInstanceInfo* info, void* ctx),
-                             void* ctx)
+void icd_foreach_ln_instance(const IcdDocument* doc, const char* iedName,
+                             void (*callback)(const LNInstanceInfo* info, void* ctx), void* ctx)
 {
-    if (!callback)
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || !callback)
         return;
 
-    for (LNInstEntry* e = ln_instances; e; e = e->next) {
+    for (size_t i = 0; i < ied->ln_inst_count; ++i) {
+        const LNInstEntry* e = &ied->ln_inst_table[i];
         LNInstanceInfo info = {0};
-        snprintf(info.ldInst, sizeof(info.ldInst), "%s", e->ldInst);
-        snprintf(info.prefix, sizeof(info.prefix), "%s", e->prefix);
-        snprintf(info.lnClass, sizeof(info.lnClass), "%s", e->lnClass);
-        snprintf(info.lnInst, sizeof(info.lnInst), "%s", e->lnInst);
-        snprintf(info.lnType, sizeof(info.lnType), "%s", e->lnType);
-        snprintf(info.lnName, sizeof(info.lnName), "%s", e->lnName);
+        snprintf(info.ldInst, sizeof(info.ldInst), "%s", sym_str(doc, e->ldInst));
+        snprintf(info.prefix, sizeof(info.prefix), "%s", sym_str(doc, e->prefix));
+        snprintf(info.lnClass, sizeof(info.lnClass), "%s", sym_str(doc, e->lnClass));
+        snprintf(info.lnInst, sizeof(info.lnInst), "%s", sym_str(doc, e->lnInst));
+        snprintf(info.lnType, sizeof(info.lnType), "%s", sym_str(doc, e->lnType));
+        snprintf(info.lnName, sizeof(info.lnName), "%s", sym_str(doc, e->lnName));
         info.isLn0 = e->isLn0;
         callback(&info, ctx);
     }
 }
 
-bool icd_find_ln_type_by_name(const char* ldInst, const char* lnName, char lnTypeOut[64])
+bool icd_find_ln_type_by_name(const IcdDocument* doc, const char* iedName, const char* ldInst, const char* lnName,
+                              char lnTypeOut[64])
 {
-    if (!lnName || !lnTypeOut)
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || !lnName || !lnTypeOut)
         return false;
 
-    for (LNInstEntry* e = ln_instances; e; e = e->next) {
-        if (ldInst && *ldInst && strcmp(e->ldInst, ldInst) != 0)
-            continue;
-        if (strcmp(e->lnName, lnName) == 0) {
-            snprintf(lnTypeOut, 64, "%s", e->lnType);
+    if (ldInst && *ldInst) {
+        char key[288];
+        uint32_t pos;
+        if (!str_index_find(&ied->ln_inst_name_index, str_index_key2(key, sizeof(key), ldInst, lnName), &pos) ||
+            pos >= ied->ln_inst_count)
+            return false;
+        snprintf(lnTypeOut, 64, "%s", sym_str(doc, ied->ln_inst_table[pos].lnType));
+        return true;
+    }
+
+    Sym name = sym_find(doc, lnName);
+    for (size_t i = 0; name != SYM_NONE && i < ied->ln_inst_count; ++i) {
+        const LNInstEntry* e = &ied->ln_inst_table[i];
+        if (e->lnName == name) {
+            snprintf(lnTypeOut, 64, "%s", sym_str(doc, e->lnType));
             return true;
         }
     }
     return false;
 }
 
-bool icd_find_ln_type_by_parts(const char* ldInst, const char* prefix, const char* lnClass, const char* lnInst, char lnTypeOut[64])
+bool icd_find_ln_type_by_parts(const IcdDocument* doc, const char* iedName, const char* ldInst, const char* prefix,
+                               const char* lnClass, const char* lnInst, char lnTypeOut[64])
 {
-    if (!lnTypeOut)
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || !lnTypeOut)
         return false;
 
-    for (LNInstEntry* e = ln_instances; e; e = e->next) {
-        if (ldInst && *ldInst && strcmp(e->ldInst, ldInst) != 0)
-            continue;
-        if (prefix && *prefix) {
-            if (strcmp(e->prefix, prefix) != 0)
-                continue;
-        } else if (e->prefix[0]) {
-            continue;
-        }
-        if (lnClass && *lnClass) {
-            if (strcmp(e->lnClass, lnClass) != 0)
-                continue;
-        }
-        if (lnInst && *lnInst) {
-            if (strcmp(e->lnInst, lnInst) != 0)
-                continue;
-        } else if (e->lnInst[0]) {
+    // Fully qualified references hit the index; a missing LD or class still matches by scan
+    if (ldInst && *ldInst && lnClass && *lnClass) {
+        char key[288];
+        uint32_t pos;
+        if (!str_index_find(&ied->ln_inst_parts_index, str_index_key4(key, sizeof(key), ldInst, prefix, lnClass, lnInst),
+                            &pos) || pos >= ied->ln_inst_count)
+            return false;
+        snprintf(lnTypeOut, 64, "%s", sym_str(doc, ied->ln_inst_table[pos].lnType));
+        return true;
+    }
+
+    // An empty prefix or lnInst must match an empty one, an empty LD or class matches any
+    Sym ld = sym_find(doc, ldInst);
+    Sym pre = sym_find(doc, prefix);
+    Sym cls = sym_find(doc, lnClass);
+    Sym inst = sym_find(doc, lnInst);
+    if (ld == SYM_NONE || pre == SYM_NONE || cls == SYM_NONE || inst == SYM_NONE)
+        return false;
+    for (size_t i = 0; i < ied->ln_inst_count; ++i) {
+        const LNInstEntry* e = &ied->ln_inst_table[i];
+        if ((ld != SYM_EMPTY && e->ldInst != ld) || e->prefix != pre ||
+            (cls != SYM_EMPTY && e->lnClass != cls) || e->lnInst != inst)
             continue;
-        }
-        snprintf(lnTypeOut, 64, "%s", e->lnType);
+        snprintf(lnTypeOut, 64, "%s", sym_str(doc, e->lnType));
         return true;
     }
     return false;
 }
 
-void icd_foreach_dataset(void (*callback)(const char* ldInst, const char* lnName, const char* dsName, void* ctx),
-                        void* ctx)
+void icd_foreach_dataset(const IcdDocument* doc, const char* iedName,
+                         void (*callback)(const char* ldInst, const char* lnName, const char* dsName, void* ctx),
+                         void* ctx)
 {
-    if (!callback)
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || !callback)
         return;
-    for (DataSetEntryDef* ds = dataset_list; ds; ds = ds->next) {
-        callback(ds->ldInst, ds->lnName, ds->name, ctx);
+    for (size_t i = 0; i < ied->dataset_count; ++i) {
+        const DataSetEntryDef* ds = &ied->dataset_table[i];
+        callback(sym_str(doc, ds->ldInst), sym_str(doc, ds->lnName), sym_str(doc, ds->name), ctx);
     }
 }
 
-void icd_foreach_dataset_fcda(const char* ldInst, const char* lnName, const char* dsName,
-                              void (*callback)(const FCDAInfo* info, void* ctx),
-                              void* ctx)
+void icd_foreach_dataset_fcda(const IcdDocument* doc, const char* iedName, const char* ldInst, const char* lnName,
+                              const char* dsName, void (*callback)(const FCDAInfo* info, void* ctx), void* ctx)
 {
-    if (!callback)
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || !callback)
         return;
-    for (DataSetEntryDef* ds = dataset_list; ds; ds = ds->next) {
-        if (ldInst && *ldInst && strcmp(ds->ldInst, ldInst) != 0)
-            continue;
-        if (lnName && *lnName && strcmp(ds->lnName, lnName) != 0)
-            continue;
-        if (dsName && *dsName && strcmp(ds->name, dsName) != 0)
+
+    size_t first = 0, last = ied->dataset_count;
+    if (ldInst && *ldInst && lnName && *lnName && dsName && *dsName &&
+        ied->dataset_index.count == ied->dataset_count) {
+        char key[288];
+        uint32_t pos;
+        if (!str_index_find(&ied->dataset_index, str_index_key3(key, sizeof(key), ldInst, lnName, dsName), &pos) ||
+            pos >= ied->dataset_count)
+            return;
+        first = pos;
+        last = pos + 1;
+    }
+
+    // Empty filters match any dataset
+    Sym ld = sym_find(doc, ldInst);
+    Sym ln = sym_find(doc, lnName);
+    Sym name = sym_find(doc, dsName);
+    if (ld == SYM_NONE || ln == SYM_NONE || name == SYM_NONE)
+        return;
+    for (size_t i = first; i < last; ++i) {
+        const DataSetEntryDef* ds = &ied->dataset_table[i];
+        if ((ld != SYM_EMPTY && ds->ldInst != ld) || (ln != SYM_EMPTY && ds->lnName != ln) ||
+            (name != SYM_EMPTY && ds->name != name))
             continue;
-        for (FcdaEntry* fcda = ds->members; fcda; fcda = fcda->next) {
+        for (size_t m = 0; m < ds->memberCount; ++m) {
+            const FcdaEntry* fcda = &ied->fcda_table[ds->firstMember + m];
             FCDAInfo info = {0};
-            snprintf(info.ldInst, sizeof(info.ldInst), "%s", fcda->ldInst);
-            snprintf(info.prefix, sizeof(info.prefix), "%s", fcda->prefix);
-            snprintf(info.lnClass, sizeof(info.lnClass), "%s", fcda->lnClass);
-            snprintf(info.lnInst, sizeof(info.lnInst), "%s", fcda->lnInst);
-            snprintf(info.doName, sizeof(info.doName), "%s", fcda->doName);
-            snprintf(info.daName, sizeof(info.daName), "%s", fcda->daName);
-            snprintf(info.fc, sizeof(info.fc), "%s", fcda->fc);
+            snprintf(info.ldInst, sizeof(info.ldInst), "%s", sym_str(doc, fcda->ldInst));
+            snprintf(info.prefix, sizeof(info.prefix), "%s", sym_str(doc, fcda->prefix));
+            snprintf(info.lnClass, sizeof(info.lnClass), "%s", sym_str(doc, fcda->lnClass));
+            snprintf(info.lnInst, sizeof(info.lnInst), "%s", sym_str(doc, fcda->lnInst));
+            snprintf(info.doName, sizeof(info.doName), "%s", sym_str(doc, fcda->doName));
+            snprintf(info.daName, sizeof(info.daName), "%s", sym_str(doc, fcda->daName));
+            snprintf(info.fc, sizeof(info.fc), "%s", sym_str(doc, fcda->fc));
             callback(&info, ctx);
         }
     }
 }
 
-bool icd_lookup_ln_class(const char* ln_name, char out[16]) {
-    if (!ln_name || !out)
+bool icd_lookup_ln_class(const IcdDocument* doc, const char* iedName, const char* ln_name, char out[16]) {
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || !ln_name || !out)
         return false;
 
-    for (LNEntry* e = ln_list; e; e = e->next) {
-        if (!strcmp(e->name, ln_name)) {
-            strncpy(out, e->lnClass, 15);
-            out[15] = '\0';
-            return true;
-        }
-    }
-    return false;
+    uint32_t pos;
+    if (!str_index_find(&ied->ln_name_index, ln_name, &pos) || pos >= ied->ln_count)
+        return false;
+    strncpy(out, sym_str(doc, ied->ln_table[pos].lnClass), 15);
+    out[15] = '\0';
+    return true;
 }
 
-void icd_foreach_report(void (*callback)(const ReportControlInfo* info, void* ctx), void* ctx)
+void icd_foreach_report(const IcdDocument* doc, const char* iedName,
+                        void (*callback)(const ReportControlInfo* info, void* ctx), void* ctx)
 {
-    if (!callback)
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || !callback)
         return;
 
-    for (ReportEntry* e = report_list; e; e = e->next) {
+    for (size_t i = 0; i < ied->report_count; ++i) {
+        const ReportEntry* e = &ied->report_table[i];
         ReportControlInfo info = {0};
-        snprintf(info.ldInst, sizeof(info.ldInst), "%s", e->ldInst);
-        snprintf(info.lnName, sizeof(info.lnName), "%s", e->lnName);
-        snprintf(info.name, sizeof(info.name), "%s", e->name);
-        snprintf(info.dataSet, sizeof(info.dataSet), "%s", e->dataSet);
-        snprintf(info.rptId, sizeof(info.rptId), "%s", e->rptId);
+        snprintf(info.ldInst, sizeof(info.ldInst), "%s", sym_str(doc, e->ldInst));
+        snprintf(info.lnName, sizeof(info.lnName), "%s", sym_str(doc, e->lnName));
+        snprintf(info.name, sizeof(info.name), "%s", sym_str(doc, e->name));
+        snprintf(info.dataSet, sizeof(info.dataSet), "%s", sym_str(doc, e->dataSet));
+        snprintf(info.rptId, sizeof(info.rptId), "%s", sym_str(doc, e->rptId));
         info.confRev = e->confRev;
         info.intgPd = e->intgPd;
         info.bufTime = e->bufTime;
@@ -1100,54 +2492,57 @@ void icd_foreach_report(void (*callback)(const ReportControlInfo* info, void* ct
     }
 }
 
-bool icd_set_active_ied(const char* name, const char* accessPoint)
+bool icd_get_first_dataset(const IcdDocument* doc, const char* iedName, const char** ldInst, const char** lnName,
+                           const char** dsName)
 {
-    if (!name || !*name)
+    const IedTables* ied = doc ? find_ied(doc, iedName) : NULL;
+    if (!ied || ied->dataset_count == 0)
         return false;
-
-    snprintf(selected_ied_name, sizeof(selected_ied_name), "%s", name);
-    if (accessPoint && *accessPoint)
-        snprintf(selected_ap_name, sizeof(selected_ap_name), "%s", accessPoint);
-    else
-        selected_ap_name[0] = '\0';
+    const DataSetEntryDef* ds = &ied->dataset_table[0];
+    if (ldInst) *ldInst = sym_str(doc, ds->ldInst);
+    if (lnName) *lnName = sym_str(doc, ds->lnName);
+    if (dsName) *dsName = sym_str(doc, ds->name);
     return true;
 }
 
-void icd_unload() {
-    while (do_list) {
-        DOEntry* tmp = do_list;
-        do_list = do_list->next;
-        free(tmp);
-    }
-    while (da_list) {
-        DAEntry* tmp = da_list;
-        da_list = da_list->next;
-        free(tmp);
-    }
-    while (ln_list) {
-        LNEntry* tmp = ln_list;
-        ln_list = ln_list->next;
-        free(tmp);
-    }
-    while (ln_instances) {
-        LNInstEntry* tmp = ln_instances;
-        ln_instances = ln_instances->next;
-        free(tmp);
-    }
-    while (dataset_list) {
-        DataSetEntryDef* ds = dataset_list;
-        dataset_list = dataset_list->next;
-        FcdaEntry* fcda = ds->members;
-        while (fcda) {
-            FcdaEntry* ftmp = fcda;
-            fcda = fcda->next;
-            free(ftmp);
-        }
-        free(ds);
-    }
-    while (report_list) {
-        ReportEntry* r = report_list;
-        report_list = report_list->next;
-        free(r);
+static void free_ied_tables(IcdDocument* doc)
+{
+    for (size_t i = 0; i < doc->ied_count; ++i) {
+        str_index_free(&doc->ieds[i].ln_name_index);
+        str_index_free(&doc->ieds[i].ln_inst_name_index);
+        str_index_free(&doc->ieds[i].ln_inst_parts_index);
+        str_index_free(&doc->ieds[i].dataset_index);
     }
+    str_index_free(&doc->ied_index);
+    arena_release(&doc->ied_arena);
+    doc->ieds = NULL;
+    doc->ied_count = doc->ied_capacity = 0;
+    doc->cur_ied = doc->default_ied = 0;
+}
+
+static void release_tables(IcdDocument* doc)
+{
+    expansion_cache_free(doc);
+    template_index_free(doc);
+    arena_release(&doc->template_arena);
+    doc->do_table = NULL;
+    doc->do_count = doc->do_capacity = 0;
+    doc->da_tables = NULL;
+    doc->da_table_count = doc->da_table_capacity = 0;
+    str_index_free(&doc->da_type_index);
+    str_index_free(&doc->da_path_index);
+    free_ied_tables(doc);
+    str_index_free(&doc->symbols);
+    arena_release(&doc->scratch_arena);
+    if (doc->model_cache_map)
+        munmap(doc->model_cache_map, doc->model_cache_size);
+    doc->model_cache_map = NULL;
+    doc->model_cache_size = 0;
+}
+
+void icd_unload(IcdDocument* doc) {
+    if (!doc)
+        return;
+    release_tables(doc);
+    free(doc);
 }
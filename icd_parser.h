@@ -9,17 +9,87 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
+
+/* One loaded SCL file. Handles are independent and may be used from different threads. */
+typedef struct IcdDocument IcdDocument;
+
+/* SCL bType values, decoded once when the DA is indexed */
+typedef enum {
+    ICD_BTYPE_NONE,       // no bType (constructed)
+    ICD_BTYPE_BOOLEAN,
+    ICD_BTYPE_INT8,
+    ICD_BTYPE_INT16,
+    ICD_BTYPE_INT32,
+    ICD_BTYPE_INT64,
+    ICD_BTYPE_INT8U,
+    ICD_BTYPE_INT16U,
+    ICD_BTYPE_INT24U,
+    ICD_BTYPE_INT32U,
+    ICD_BTYPE_FLOAT32,
+    ICD_BTYPE_FLOAT64,
+    ICD_BTYPE_ENUM,
+    ICD_BTYPE_DBPOS,
+    ICD_BTYPE_QUALITY,
+    ICD_BTYPE_TIMESTAMP,
+    ICD_BTYPE_CHECK,
+    ICD_BTYPE_OCTET64,
+    ICD_BTYPE_OCTET6,
+    ICD_BTYPE_OCTET8,
+    ICD_BTYPE_VISSTRING32,
+    ICD_BTYPE_VISSTRING64,
+    ICD_BTYPE_VISSTRING65,
+    ICD_BTYPE_VISSTRING129,
+    ICD_BTYPE_VISSTRING255,
+    ICD_BTYPE_UNICODE255,
+    ICD_BTYPE_ENTRYTIME,
+    ICD_BTYPE_OPTFLDS,
+    ICD_BTYPE_TRGOPS,
+    ICD_BTYPE_OBJREF,
+    ICD_BTYPE_STRUCT,
+    ICD_BTYPE_OTHER,      // any other non-empty bType
+    ICD_BTYPE_COUNT
+} IcdBType;
+
+/* Functional constraints, in the order of libiec61850's FunctionalConstraint */
+typedef enum {
+    ICD_FC_NONE,          // no fc attribute
+    ICD_FC_ST, ICD_FC_MX, ICD_FC_SP, ICD_FC_SV, ICD_FC_CF, ICD_FC_DC, ICD_FC_SG, ICD_FC_SE, ICD_FC_SR,
+    ICD_FC_OR, ICD_FC_BL, ICD_FC_EX, ICD_FC_CO, ICD_FC_US, ICD_FC_MS, ICD_FC_RP, ICD_FC_BR, ICD_FC_LG,
+    ICD_FC_GO,
+    ICD_FC_OTHER,
+    ICD_FC_COUNT
+} IcdFc;
+
+/* Common data classes of IEC 61850-7-3 */
+typedef enum {
+    ICD_CDC_NONE,
+    ICD_CDC_SPS, ICD_CDC_DPS, ICD_CDC_INS, ICD_CDC_ENS, ICD_CDC_ACT, ICD_CDC_ACD, ICD_CDC_SEC, ICD_CDC_BCR,
+    ICD_CDC_HST, ICD_CDC_VSS,
+    ICD_CDC_MV, ICD_CDC_CMV, ICD_CDC_SAV, ICD_CDC_WYE, ICD_CDC_DEL, ICD_CDC_SEQ, ICD_CDC_HMV, ICD_CDC_HWYE,
+    ICD_CDC_HDEL,
+    ICD_CDC_SPC, ICD_CDC_DPC, ICD_CDC_INC, ICD_CDC_ENC, ICD_CDC_BSC, ICD_CDC_ISC, ICD_CDC_APC, ICD_CDC_BAC,
+    ICD_CDC_SPG, ICD_CDC_ING, ICD_CDC_ENG, ICD_CDC_ORG, ICD_CDC_TSG, ICD_CDC_CUG, ICD_CDC_VSG, ICD_CDC_ASG,
+    ICD_CDC_CURVE, ICD_CDC_CSG,
+    ICD_CDC_DPL, ICD_CDC_LPL, ICD_CDC_CSD,
+    ICD_CDC_OTHER,
+    ICD_CDC_COUNT
+} IcdCdc;
 
 typedef struct {
     char do_type_id[64];  // Example: "SPC_DO"
     char cdc[16];         // Example: "SPC"
+    IcdCdc cdcCode;
 } DOInfo;
 
+/* Strings point into the document and stay valid until icd_unload */
 typedef struct {
-    char fc[8];          // Example: "ST"
-    char bType[32];       // Example: "BOOLEAN"
-    char typeId[64];
+    const char* fc;       // Example: "ST"
+    const char* bType;    // Example: "BOOLEAN"
+    const char* typeId;
     uint8_t trgOps;
+    IcdBType bTypeCode;
+    IcdFc fcCode;
 } DAInfo;
 
 typedef struct {
@@ -42,30 +112,69 @@ typedef struct {
     int isLn0;
 } LNInstanceInfo;
 
-bool icd_load(const char* path);
+typedef struct {
+    size_t templateCount;    // indexed LNodeType/DOType/DAType/EnumType definitions
+    size_t templateLookups;  // id resolutions during expansion
+    size_t templateMisses;   // lookups for ids that are not defined
+    size_t doTypeExpansions; // DOType (or SDO subtree) walks
+    size_t doTypeReuses;     // references answered by an earlier expansion
+    size_t daTypeExpansions; // DAType subtrees flattened into the cache
+    size_t daTypeReuses;     // cached DAType subtrees grafted again
+    size_t lnTypesSkipped;   // LNodeTypes not instantiated by the selected IED
+    size_t doTypesSkipped;   // DOTypes outside the closure of the expanded LNodeTypes
+    size_t daTypesSkipped;   // DATypes outside that closure (EnumTypes are not counted)
+    size_t arenaBytes;       // memory reserved for the parser tables
+    size_t arenaChunks;
+    size_t attrReads;        // attribute lookups on SCL elements
+    size_t attrCopies;       // values that had to be copied out of the tree (one allocation each)
+    size_t symbolCount;      // distinct identifiers the tables refer to
+    size_t symbolBytes;      // their text, stored once
+} IcdParseStats;
+
+typedef struct {
+    const char* iedName;      // IED to load, NULL = first named IED
+    const char* accessPoint;  // AccessPoint of that IED, NULL = first one
+    bool streaming;           // pull reader instead of a full DOM
+    const char* cachePath;    // binary table cache to reuse or refresh, NULL = always parse
+    bool allIeds;             // index every IED; iedName then only picks the default one
+} IcdLoadOptions;
+
+/* Returns NULL on failure. options may be NULL. */
+IcdDocument* icd_load(const char* path, const IcdLoadOptions* options);
+void icd_get_parse_stats(const IcdDocument* doc, IcdParseStats* out);
+
+/*
+ * Indexed IEDs in file order. Queries below that take an iedName are scoped
+ * to that IED; NULL or "" means the default (selected) one.
+ */
+size_t icd_ied_count(const IcdDocument* doc);
+const char* icd_ied_name(const IcdDocument* doc, size_t index);
 
-bool icd_find_do_info(const char* lnTypeId, const char* do_name, DOInfo* out);
-bool icd_find_da_info(const char* do_type_id, const char* da_path, DAInfo* out);
-bool icd_da_exists(const char* do_type_id, const char* da_path);
-bool icd_lookup_ln_class(const char* ln_name, char out[16]);
-void icd_foreach_da(const char* do_type_id,
+bool icd_find_do_info(const IcdDocument* doc, const char* lnTypeId, const char* do_name, DOInfo* out);
+bool icd_find_da_info(const IcdDocument* doc, const char* do_type_id, const char* da_path, DAInfo* out);
+bool icd_da_exists(const IcdDocument* doc, const char* do_type_id, const char* da_path);
+bool icd_lookup_ln_class(const IcdDocument* doc, const char* iedName, const char* ln_name, char out[16]);
+/* path, like the DAInfo strings, points into the document */
+void icd_foreach_da(const IcdDocument* doc, const char* do_type_id,
                     void (*callback)(const char* path, const DAInfo* info, void* ctx),
                     void* ctx);
-void icd_foreach_do(const char* lnTypeId,
+void icd_foreach_do(const IcdDocument* doc, const char* lnTypeId,
                     void (*callback)(const char* doName, const DOInfo* info, void* ctx),
                     void* ctx);
-void icd_foreach_ln_instance(void (*callback)(const LNInstanceInfo* info, void* ctx),
-                             void* ctx);
-const char* icd_get_selected_ied_name(void);
-bool icd_set_active_ied(const char* name, const char* accessPoint);
-bool icd_get_first_dataset(const char** ldInst, const char** lnName, const char** dsName);
-void icd_foreach_dataset(void (*callback)(const char* ldInst, const char* lnName, const char* dsName, void* ctx),
-                        void* ctx);
-void icd_foreach_dataset_fcda(const char* ldInst, const char* lnName, const char* dsName,
-                              void (*callback)(const FCDAInfo* info, void* ctx),
-                              void* ctx);
-bool icd_find_ln_type_by_name(const char* ldInst, const char* lnName, char lnTypeOut[64]);
-bool icd_find_ln_type_by_parts(const char* ldInst, const char* prefix, const char* lnClass, const char* lnInst, char lnTypeOut[64]);
+void icd_foreach_ln_instance(const IcdDocument* doc, const char* iedName,
+                             void (*callback)(const LNInstanceInfo* info, void* ctx), void* ctx);
+const char* icd_get_selected_ied_name(const IcdDocument* doc);
+bool icd_get_first_dataset(const IcdDocument* doc, const char* iedName, const char** ldInst, const char** lnName,
+                           const char** dsName);
+void icd_foreach_dataset(const IcdDocument* doc, const char* iedName,
+                         void (*callback)(const char* ldInst, const char* lnName, const char* dsName, void* ctx),
+                         void* ctx);
+void icd_foreach_dataset_fcda(const IcdDocument* doc, const char* iedName, const char* ldInst, const char* lnName,
+                              const char* dsName, void (*callback)(const FCDAInfo* info, void* ctx), void* ctx);
+bool icd_find_ln_type_by_name(const IcdDocument* doc, const char* iedName, const char* ldInst, const char* lnName,
+                              char lnTypeOut[64]);
+bool icd_find_ln_type_by_parts(const IcdDocument* doc, const char* iedName, const char* ldInst, const char* prefix,
+                               const char* lnClass, const char* lnInst, char lnTypeOut[64]);
 
 typedef struct {
     char ldInst[64];
@@ -82,6 +191,7 @@ typedef struct {
     int buffered;
 } ReportControlInfo;
 
-void icd_foreach_report(void (*callback)(const ReportControlInfo* info, void* ctx), void* ctx);
+void icd_foreach_report(const IcdDocument* doc, const char* iedName,
+                        void (*callback)(const ReportControlInfo* info, void* ctx), void* ctx);
 
-void icd_unload(void);
+void icd_unload(IcdDocument* doc);
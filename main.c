@@ -9,19 +9,230 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <arpa/inet.h>
 
 #include "icd_parser.h"
 #include "model_iec.h"
+#include "model_static.h"
+#include "model_cfg.h"
+#include "run_config.h"
 
 #define DEFAULT_PORT 102
 
+static long peak_rss_kib(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return usage.ru_maxrss;
+}
+
+#ifdef STATIC_MODEL
+
+extern IedModel iedModel; // generated with --emit-static-model
+
+int main(int argc, char** argv)
+{
+    int tcp_port = argc > 1 ? atoi(argv[1]) : DEFAULT_PORT;
+
+    ServerCtx ctx = {0};
+    ctx.model = &iedModel;
+    ctx.static_model = true;
+    snprintf(ctx.ied_name, sizeof(ctx.ied_name), "%s", iedModel.name ? iedModel.name : "");
+    if (index_model_attributes(&ctx) != 0)
+        return 4;
+    printf("Static model '%s', peak RSS %ld KiB\n", ctx.ied_name, peak_rss_kib());
+
+    int rc = start_server(&ctx, tcp_port);
+    release_server_ctx(&ctx);
+    return rc;
+}
+
+#else
+
+static double elapsed_ms(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) * 1000.0 +
+           (double)(now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static long current_rss_kib(void)
+{
+    long pages = 0, resident = 0;
+    FILE* fp = fopen("/proc/self/statm", "r");
+    if (!fp)
+        return -1;
+    if (fscanf(fp, "%ld %ld", &pages, &resident) != 2)
+        resident = -1;
+    fclose(fp);
+    return resident < 0 ? -1 : resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/* ---------- --serve-all-ieds ---------- */
+
+// base + n as an IPv4 address, for one local IP alias per IED
+static bool nth_ipv4(const char* base, size_t n, char out[48])
+{
+    struct in_addr addr;
+    if (inet_pton(AF_INET, base, &addr) != 1)
+        return false;
+    uint32_t host = ntohl(addr.s_addr) + (uint32_t)n;
+    addr.s_addr = htonl(host);
+    return inet_ntop(AF_INET, &addr, out, 48) != NULL;
+}
+
+/*
+ * One model and server per entry of ieds, all built from the single load of
+ * a multi-IED document. Prints the memory each further IED costs.
+ */
+static int serve_ieds(IcdDocument* icd, const RunIed* ieds, size_t count, bool build_only)
+{
+    ServerCtx* ctxs = calloc(count ? count : 1, sizeof(ServerCtx));
+    int* ports = calloc(count ? count : 1, sizeof(int));
+    if (!ctxs || !ports || count == 0) {
+        fprintf(stderr, "❌ No IEDs to serve\n");
+        free(ctxs);
+        free(ports);
+        return 4;
+    }
+
+    int rc = 0;
+    long rssBefore = current_rss_kib();
+    long rssFirst = rssBefore;
+    struct timespec build_start;
+    clock_gettime(CLOCK_MONOTONIC, &build_start);
+    for (size_t i = 0; i < count; ++i) {
+        ServerCtx* ctx = &ctxs[i];
+        const RunIed* ied = &ieds[i];
+        ctx->build_threads = ied->build_threads;
+        ctx->server_threads = ied->server_threads;
+        ctx->cpu_mask = ied->cpu_mask;
+        ctx->rt_priority = ied->rt_priority;
+        snprintf(ctx->local_ip, sizeof(ctx->local_ip), "%s", ied->local_ip);
+        ports[i] = ied->tcp_port;
+        if (build_model_from_icd(ctx, icd, ied->name) != 0) {
+            fprintf(stderr, "❌ Failed to build model of IED %s\n", ied->name);
+            rc = 4;
+            break;
+        }
+        if (ied->mapping_path[0])
+            printf("IED %s: %zu mapping rows from %s\n", ctx->ied_name, ied->mapping.count, ied->mapping_path);
+        if (i == 0)
+            rssFirst = current_rss_kib();
+    }
+
+    if (rc == 0) {
+        long rssAll = current_rss_kib();
+        printf("Built %zu IEDs: %.1f ms, first IED %ld KiB, each further IED %ld KiB on average, RSS %ld KiB\n",
+               count, elapsed_ms(&build_start), rssFirst - rssBefore,
+               count > 1 ? (rssAll - rssFirst) / (long)(count - 1) : 0L, rssAll);
+        if (!build_only)
+            rc = start_servers(ctxs, ports, count) == 0 ? 0 : 6;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        release_server_ctx(&ctxs[i]);
+    free(ctxs);
+    free(ports);
+    return rc;
+}
+
+/* IED i listens on tcp_port + i, or with ip_base on tcp_port at ip_base + i */
+static int serve_all_ieds(IcdDocument* icd, int tcp_port, const char* ip_base, int build_threads,
+                          int server_threads, bool build_only)
+{
+    size_t count = icd_ied_count(icd);
+    RunIed* ieds = calloc(count ? count : 1, sizeof(RunIed));
+    if (!ieds)
+        return 4;
+    for (size_t i = 0; i < count; ++i) {
+        RunIed* ied = &ieds[i];
+        snprintf(ied->name, sizeof(ied->name), "%s", icd_ied_name(icd, i));
+        ied->build_threads = build_threads;
+        ied->server_threads = server_threads;
+        ied->tcp_port = ip_base ? tcp_port : tcp_port + (int)i;
+        if (ip_base && !nth_ipv4(ip_base, i, ied->local_ip)) {
+            fprintf(stderr, "❌ Invalid --ip-base %s\n", ip_base);
+            free(ieds);
+            return 1;
+        }
+    }
+    int rc = serve_ieds(icd, ieds, count, build_only);
+    free(ieds);
+    return rc;
+}
+
+/* ---------- --config ---------- */
+
+static int serve_run_config(const char* config_path, bool build_only)
+{
+    RunConfig cfg;
+    char err[512];
+    if (!load_run_config(config_path, &cfg, err, sizeof(err))) {
+        fprintf(stderr, "❌ Run config %s: %s\n", config_path, err);
+        return 1;
+    }
+
+    IcdLoadOptions load_opts = { .accessPoint = cfg.access_point[0] ? cfg.access_point : NULL,
+                                 .streaming = cfg.stream, .cachePath = cfg.cache_path[0] ? cfg.cache_path : NULL,
+                                 .allIeds = true };
+    struct timespec load_start;
+    clock_gettime(CLOCK_MONOTONIC, &load_start);
+    IcdDocument* icd = icd_load(cfg.icd_path, &load_opts);
+    if (!icd) {
+        fprintf(stderr, "❌ Failed to load CID/ICD file: %s\n", cfg.icd_path);
+        free_run_config(&cfg);
+        return 3;
+    }
+    printf("ICD load: %.1f ms (%s parser), peak RSS %ld KiB\n",
+           elapsed_ms(&load_start), cfg.stream ? "streaming" : "DOM", peak_rss_kib());
+
+    // A name the SCD does not contain would otherwise build an empty model
+    StrIndex names;
+    str_index_init(&names, icd_ied_count(icd));
+    for (size_t i = 0; i < icd_ied_count(icd); ++i)
+        str_index_insert(&names, icd_ied_name(icd, i), (uint32_t)i);
+    int rc = 0;
+    for (size_t i = 0; i < cfg.ied_count; ++i) {
+        if (cfg.ieds[i].name[0] && !str_index_find(&names, cfg.ieds[i].name, NULL)) {
+            fprintf(stderr, "❌ Run config %s: IED %s is not in %s\n", config_path, cfg.ieds[i].name,
+                    cfg.icd_path);
+            rc = 4;
+        }
+    }
+    str_index_free(&names);
+
+    if (rc == 0) {
+        printf("Run config %s: serving %zu of %zu IEDs\n", config_path, cfg.ied_count, icd_ied_count(icd));
+        rc = serve_ieds(icd, cfg.ieds, cfg.ied_count, build_only);
+    }
+    icd_unload(icd);
+    free_run_config(&cfg);
+    return rc;
+}
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <model.cid> [tcp_port] [--ied NAME] [--ap ACCESSPOINT]\n", argv[0]);
+        fprintf(stderr, "Usage: %s <model.cid> [tcp_port] [--ied NAME] [--ap ACCESSPOINT] [--stream] [--cache FILE] [--all-ieds] [--build-threads N] [--build-only] [--emit-static-model FILE] [--emit-model-cfg FILE] [--model-cfg] [--threads N] [--serve-all-ieds] [--ip-base ADDRESS]\n", argv[0]);
+        fprintf(stderr, "       %s --config FILE.json [--build-only]\n", argv[0]);
         return 1;
     }
 
+    if (strcmp(argv[1], "--config") == 0) {
+        bool only_build = argc == 4 && strcmp(argv[3], "--build-only") == 0;
+        if (argc < 3 || (argc > 3 && !only_build)) {
+            fprintf(stderr, "Usage: %s --config FILE.json [--build-only]\n", argv[0]);
+            return 1;
+        }
+        return serve_run_config(argv[2], only_build);
+    }
+
     const char* cid_path = argv[1];
 
     int tcp_port = DEFAULT_PORT;
@@ -33,6 +244,17 @@ int main(int argc, char** argv)
 
     const char* ied_name = NULL;
     const char* ap_name = NULL;
+    const char* cache_path = NULL;
+    bool stream = false;
+    bool all_ieds = false;
+    int build_threads = 1;
+    int server_threads = 0;
+    bool serve_all = false;
+    const char* ip_base = NULL;
+    bool build_only = false;
+    const char* static_model_path = NULL;
+    const char* model_cfg_path = NULL;
+    bool from_cfg = false;
     while (argi < argc) {
         if (strcmp(argv[argi], "--ied") == 0) {
             if (argi + 1 >= argc) {
@@ -50,26 +272,158 @@ int main(int argc, char** argv)
             ap_name = argv[argi + 1];
             argi += 2;
         }
+        else if (strcmp(argv[argi], "--cache") == 0) {
+            if (argi + 1 >= argc) {
+                fprintf(stderr, "Missing value for --cache\n");
+                return 1;
+            }
+            cache_path = argv[argi + 1];
+            argi += 2;
+        }
+        else if (strcmp(argv[argi], "--stream") == 0) {
+            stream = true;
+            argi++;
+        }
+        else if (strcmp(argv[argi], "--all-ieds") == 0) {
+            all_ieds = true;
+            argi++;
+        }
+        else if (strcmp(argv[argi], "--build-threads") == 0) {
+            if (argi + 1 >= argc || atoi(argv[argi + 1]) < 1) {
+                fprintf(stderr, "Missing or invalid value for --build-threads\n");
+                return 1;
+            }
+            build_threads = atoi(argv[argi + 1]);
+            argi += 2;
+        }
+        else if (strcmp(argv[argi], "--threads") == 0) {
+            if (argi + 1 >= argc || atoi(argv[argi + 1]) < 1) {
+                fprintf(stderr, "Missing or invalid value for --threads\n");
+                return 1;
+            }
+            server_threads = atoi(argv[argi + 1]);
+            argi += 2;
+        }
+        else if (strcmp(argv[argi], "--emit-static-model") == 0) {
+            if (argi + 1 >= argc) {
+                fprintf(stderr, "Missing value for --emit-static-model\n");
+                return 1;
+            }
+            static_model_path = argv[argi + 1];
+            argi += 2;
+        }
+        else if (strcmp(argv[argi], "--emit-model-cfg") == 0) {
+            if (argi + 1 >= argc) {
+                fprintf(stderr, "Missing value for --emit-model-cfg\n");
+                return 1;
+            }
+            model_cfg_path = argv[argi + 1];
+            argi += 2;
+        }
+        else if (strcmp(argv[argi], "--model-cfg") == 0) {
+            from_cfg = true;
+            argi++;
+        }
+        else if (strcmp(argv[argi], "--serve-all-ieds") == 0) {
+            serve_all = true;
+            all_ieds = true;
+            argi++;
+        }
+        else if (strcmp(argv[argi], "--ip-base") == 0) {
+            if (argi + 1 >= argc) {
+                fprintf(stderr, "Missing value for --ip-base\n");
+                return 1;
+            }
+            ip_base = argv[argi + 1];
+            argi += 2;
+        }
+        else if (strcmp(argv[argi], "--build-only") == 0) {
+            build_only = true;
+            argi++;
+        }
         else {
             fprintf(stderr, "Unknown argument: %s\n", argv[argi]);
             return 1;
         }
     }
 
-    if (ied_name)
-        icd_set_active_ied(ied_name, ap_name);
-
-    if (!icd_load(cid_path)) {
-        fprintf(stderr, "❌ Failed to load CID/ICD file: %s\n", cid_path);
-        return 3;
+    if (serve_all && (from_cfg || static_model_path || model_cfg_path)) {
+        fprintf(stderr, "--serve-all-ieds cannot be combined with --model-cfg or the --emit-* options\n");
+        return 1;
     }
 
     ServerCtx ctx = {0};
-    if (build_model_from_icd(&ctx) != 0) {
-        fprintf(stderr, "❌ Failed to build model from ICD\n");
-        return 4;
+    IcdDocument* icd = NULL;
+    if (from_cfg) {
+        // The model file is a config file written by --emit-model-cfg
+        struct timespec load_start;
+        clock_gettime(CLOCK_MONOTONIC, &load_start);
+        if (load_model_cfg(&ctx, cid_path) != 0)
+            return 3;
+        printf("Model config load: %.1f ms, peak RSS %ld KiB\n", elapsed_ms(&load_start), peak_rss_kib());
     }
+    else {
+        IcdLoadOptions load_opts = { .iedName = ied_name, .accessPoint = ap_name, .streaming = stream,
+                                     .cachePath = cache_path, .allIeds = all_ieds };
+
+        struct timespec load_start;
+        clock_gettime(CLOCK_MONOTONIC, &load_start);
+        icd = icd_load(cid_path, &load_opts);
+        if (!icd) {
+            fprintf(stderr, "❌ Failed to load CID/ICD file: %s\n", cid_path);
+            return 3;
+        }
+        printf("ICD load: %.1f ms (%s parser), peak RSS %ld KiB\n",
+               elapsed_ms(&load_start), stream ? "streaming" : "DOM", peak_rss_kib());
+        if (serve_all) {
+            printf("ICD indexed %zu IEDs, serving all of them\n", icd_ied_count(icd));
+            int rc = serve_all_ieds(icd, tcp_port, ip_base, build_threads, server_threads, build_only);
+            icd_unload(icd);
+            return rc;
+        }
+        if (all_ieds)
+            printf("ICD indexed %zu IEDs, serving '%s'\n", icd_ied_count(icd), icd_get_selected_ied_name(icd));
+
+        ctx.build_threads = build_threads;
+        struct timespec build_start;
+        clock_gettime(CLOCK_MONOTONIC, &build_start);
+        if (build_model_from_icd(&ctx, icd, NULL) != 0) {
+            fprintf(stderr, "❌ Failed to build model from ICD\n");
+            release_server_ctx(&ctx);
+            icd_unload(icd);
+            return 4;
+        }
+        printf("Model build: %.1f ms (%d thread%s), peak RSS %ld KiB\n",
+               elapsed_ms(&build_start), build_threads, build_threads == 1 ? "" : "s", peak_rss_kib());
+    }
+    if (static_model_path || model_cfg_path) {
+        int emitted = 0;
+        if (static_model_path) {
+            emitted = emit_static_model(&ctx, static_model_path);
+            if (emitted == 0)
+                printf("Static model written to %s\n", static_model_path);
+        }
+        if (emitted == 0 && model_cfg_path) {
+            emitted = emit_model_cfg(&ctx, model_cfg_path);
+            if (emitted == 0)
+                printf("Model config written to %s\n", model_cfg_path);
+        }
+        release_server_ctx(&ctx);
+        icd_unload(icd);
+        return emitted == 0 ? 0 : 5;
+    }
+    if (build_only) {
+        release_server_ctx(&ctx);
+        icd_unload(icd);
+        return 0;
+    }
+    ctx.server_threads = server_threads;
     // dump_model(ctx.model); // uncomment for debugging if you need to inspect the model tree
 
-    return start_server(&ctx, tcp_port);
+    int rc = start_server(&ctx, tcp_port);
+    release_server_ctx(&ctx);
+    icd_unload(icd);
+    return rc;
 }
+
+#endif /* STATIC_MODEL */
@@ -0,0 +1,235 @@
+/*
+ * File: model_cfg.c
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Writes and loads a built model in the libiec61850 text config-file format.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "model_cfg.h"
+#include "str_index.h"
+
+#include "iec61850_model.h"
+#include "iec61850_config_file_parser.h"
+
+#define CFG_NONE UINT32_MAX
+
+/*
+ * The config format nests datasets and RCBs inside their LN, while the model
+ * keeps them in two flat lists. They are chained per LN before writing.
+ */
+typedef struct {
+    FILE* fp;
+    StrIndex lnSlots;            // (LD name, LN name) -> LN position in model order
+    size_t lnCount;
+    uint32_t* firstDataSet;      // per LN, CFG_NONE = no dataset
+    uint32_t* firstRcb;          // per LN, CFG_NONE = no RCB
+    DataSet** dataSets;
+    uint32_t* nextDataSet;
+    ReportControlBlock** rcbs;
+    uint32_t* nextRcb;
+} CfgWriter;
+
+static void cfg_writer_free(CfgWriter* w)
+{
+    str_index_free(&w->lnSlots);
+    free(w->firstDataSet);
+    free(w->firstRcb);
+    free(w->dataSets);
+    free(w->nextDataSet);
+    free(w->rcbs);
+    free(w->nextRcb);
+}
+
+static bool ln_slot(const CfgWriter* w, const char* ldName, const char* lnName, uint32_t* slot)
+{
+    char key[256];
+    return str_index_find(&w->lnSlots, str_index_key2(key, sizeof(key), ldName, lnName), slot);
+}
+
+/* ---------- grouping ---------- */
+
+static bool collect_model(CfgWriter* w, IedModel* model)
+{
+    size_t dsCount = 0, rcbCount = 0;
+    for (DataSet* ds = model->dataSets; ds; ds = ds->sibling)
+        dsCount++;
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling)
+        rcbCount++;
+
+    str_index_init(&w->lnSlots, 256);
+    for (LogicalDevice* ld = model->firstChild; ld; ld = (LogicalDevice*)ld->sibling) {
+        for (ModelNode* ln = ld->firstChild; ln; ln = ln->sibling) {
+            char key[256];
+            if (!str_index_insert(&w->lnSlots, str_index_key2(key, sizeof(key), ld->name, ln->name),
+                                  (uint32_t)w->lnCount))
+                return false;
+            w->lnCount++;
+        }
+    }
+
+    w->firstDataSet = malloc((w->lnCount + 1) * sizeof(uint32_t));
+    w->firstRcb = malloc((w->lnCount + 1) * sizeof(uint32_t));
+    w->dataSets = malloc((dsCount + 1) * sizeof(DataSet*));
+    w->nextDataSet = malloc((dsCount + 1) * sizeof(uint32_t));
+    w->rcbs = malloc((rcbCount + 1) * sizeof(ReportControlBlock*));
+    w->nextRcb = malloc((rcbCount + 1) * sizeof(uint32_t));
+    if (!w->firstDataSet || !w->firstRcb || !w->dataSets || !w->nextDataSet || !w->rcbs || !w->nextRcb)
+        return false;
+    for (size_t i = 0; i < w->lnCount; ++i)
+        w->firstDataSet[i] = w->firstRcb[i] = CFG_NONE;
+
+    size_t n = 0;
+    for (DataSet* ds = model->dataSets; ds; ds = ds->sibling)
+        w->dataSets[n++] = ds;
+    n = 0;
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling)
+        w->rcbs[n++] = rcb;
+
+    // Prepending from the back keeps each chain in model order
+    for (size_t i = dsCount; i-- > 0;) {
+        DataSet* ds = w->dataSets[i];
+        char lnName[130];
+        const char* sep = strchr(ds->name, '$');
+        size_t len = sep ? (size_t)(sep - ds->name) : 0;
+        uint32_t slot;
+        if (len == 0 || len >= sizeof(lnName)) {
+            fprintf(stderr, "⚠️ Dataset %s has no LN prefix, not exported\n", ds->name);
+            continue;
+        }
+        memcpy(lnName, ds->name, len);
+        lnName[len] = '\0';
+        if (!ln_slot(w, ds->logicalDeviceName, lnName, &slot)) {
+            fprintf(stderr, "⚠️ LN of dataset %s/%s not in the model, not exported\n",
+                    ds->logicalDeviceName, ds->name);
+            continue;
+        }
+        w->nextDataSet[i] = w->firstDataSet[slot];
+        w->firstDataSet[slot] = (uint32_t)i;
+    }
+    for (size_t i = rcbCount; i-- > 0;) {
+        ReportControlBlock* rcb = w->rcbs[i];
+        LogicalNode* ln = rcb->parent;
+        uint32_t slot;
+        if (!ln || !ln->parent || !ln_slot(w, ln->parent->name, ln->name, &slot)) {
+            fprintf(stderr, "⚠️ LN of RCB %s not in the model, not exported\n", rcb->name);
+            continue;
+        }
+        w->nextRcb[i] = w->firstRcb[slot];
+        w->firstRcb[slot] = (uint32_t)i;
+    }
+    return true;
+}
+
+/* ---------- writing ---------- */
+
+static void write_node(FILE* fp, ModelNode* node)
+{
+    if (node->modelType == DataObjectModelType) {
+        fprintf(fp, "DO(%s %d){\n", node->name, ((DataObject*)node)->elementCount);
+    }
+    else {
+        DataAttribute* da = (DataAttribute*)node;
+        fprintf(fp, "DA(%s %d %d %d %u %u)%s\n", node->name, da->elementCount, (int)da->type, (int)da->fc,
+                (unsigned)da->triggerOptions, (unsigned)da->sAddr, node->firstChild ? "{" : ";");
+        if (!node->firstChild)
+            return;
+    }
+    for (ModelNode* child = node->firstChild; child; child = child->sibling)
+        write_node(fp, child);
+    fputs("}\n", fp);
+}
+
+static void write_data_set(FILE* fp, DataSet* ds)
+{
+    fprintf(fp, "DS(%s){\n", strchr(ds->name, '$') + 1);
+    for (DataSetEntry* e = ds->fcdas; e; e = e->sibling) {
+        if (e->index != -1 || e->componentName)
+            fprintf(stderr, "⚠️ Array index/component of %s in dataset %s not exported\n",
+                    e->variableName, ds->name);
+        if (e->logicalDeviceName)
+            fprintf(fp, "DE(%s/%s);\n", e->logicalDeviceName, e->variableName);
+        else
+            fprintf(fp, "DE(%s);\n", e->variableName);
+    }
+    fputs("}\n", fp);
+}
+
+static void write_rcb(FILE* fp, ReportControlBlock* rcb)
+{
+    // "-" stands for a missing rptID / dataset reference
+    fprintf(fp, "RC(%s %s %d %s %u %u %u %u %u);\n", rcb->name, rcb->rptId ? rcb->rptId : "-",
+            rcb->buffered ? 1 : 0, rcb->dataSetName ? rcb->dataSetName : "-", (unsigned)rcb->confRef,
+            (unsigned)rcb->trgOps, (unsigned)rcb->options, (unsigned)rcb->bufferTime,
+            (unsigned)rcb->intPeriod);
+}
+
+static void write_model(const CfgWriter* w, IedModel* model)
+{
+    FILE* fp = w->fp;
+    uint32_t slot = 0;
+    fprintf(fp, "MODEL(%s){\n", model->name);
+    for (LogicalDevice* ld = model->firstChild; ld; ld = (LogicalDevice*)ld->sibling) {
+        fprintf(fp, "LD(%s){\n", ld->name);
+        for (ModelNode* ln = ld->firstChild; ln; ln = ln->sibling, ++slot) {
+            fprintf(fp, "LN(%s){\n", ln->name);
+            for (ModelNode* dobj = ln->firstChild; dobj; dobj = dobj->sibling)
+                write_node(fp, dobj);
+            for (uint32_t i = w->firstDataSet[slot]; i != CFG_NONE; i = w->nextDataSet[i])
+                write_data_set(fp, w->dataSets[i]);
+            for (uint32_t i = w->firstRcb[slot]; i != CFG_NONE; i = w->nextRcb[i])
+                write_rcb(fp, w->rcbs[i]);
+            fputs("}\n", fp);
+        }
+        fputs("}\n", fp);
+    }
+    fputs("}\n", fp);
+}
+
+int emit_model_cfg(const ServerCtx* ctx, const char* path)
+{
+    if (!ctx || !ctx->model || !path)
+        return -1;
+
+    CfgWriter w = {0};
+    if (!collect_model(&w, ctx->model)) {
+        fprintf(stderr, "❌ OOM while grouping datasets and RCBs for %s\n", path);
+        cfg_writer_free(&w);
+        return -1;
+    }
+
+    w.fp = fopen(path, "w");
+    if (!w.fp) {
+        fprintf(stderr, "❌ Cannot write model config %s\n", path);
+        cfg_writer_free(&w);
+        return -1;
+    }
+    write_model(&w, ctx->model);
+    int rc = ferror(w.fp) ? -1 : 0;
+    if (fclose(w.fp) != 0)
+        rc = -1;
+    if (rc != 0)
+        fprintf(stderr, "❌ Failed writing model config %s\n", path);
+
+    cfg_writer_free(&w);
+    return rc;
+}
+
+/* ---------- loading ---------- */
+
+int load_model_cfg(ServerCtx* ctx, const char* path)
+{
+    if (!ctx || !path)
+        return -1;
+
+    ctx->model = ConfigFileParser_createModelFromConfigFileEx(path);
+    if (!ctx->model) {
+        fprintf(stderr, "❌ Failed to load model config %s\n", path);
+        return -1;
+    }
+    snprintf(ctx->ied_name, sizeof(ctx->ied_name), "%s", ctx->model->name ? ctx->model->name : "");
+    return index_model_attributes(ctx);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+ * File: model_cfg.h
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Writes and loads a built model in the libiec61850 text config-file format.
+ */
+
+#include "model_iec.h"
+
+/*
+ * Writes ctx->model (after build_model_from_icd) with its datasets and RCBs in
+ * the format read by the SDK's ConfigFileParser. Returns 0 on success.
+ */
+int emit_model_cfg(const ServerCtx* ctx, const char* path);
+
+/*
+ * Creates ctx->model from a config file written by emit_model_cfg, without the
+ * ICD parser. ctx->icd stays NULL. Returns 0 on success.
+ */
+int load_model_cfg(ServerCtx* ctx, const char* path);
@@ -5,25 +5,46 @@
  * Description: Builds the dynamic IEC 61850 model and starts the MMS server.
  */
 
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <ctype.h>
-#include <strings.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
 
 #include "model_iec.h"
 #include "icd_parser.h"
+#include "str_index.h"
+#include "report_sched.h"
 
 #include "iec61850_common.h"
 #include "iec61850_server.h"
 #include "iec61850_dynamic_model.h"
 #include "iec61850_model.h"
+#include "hal_time.h"
+
+/* Room for one more element; returns the (possibly moved) array or NULL */
+static void* reserve_array(void* items, size_t count, size_t* capacity, size_t elemSize)
+{
+    if (count < *capacity)
+        return items;
+    size_t newCap = *capacity ? *capacity * 2 : 16;
+    void* grown = realloc(items, newCap * elemSize);
+    if (grown)
+        *capacity = newCap;
+    return grown;
+}
+
+/* A STATIC_MODEL build links a generated model (see model_static.h) and leaves the ICD builder out */
+#ifndef STATIC_MODEL
 
 typedef struct {
-    char path[128];
+    const char* path;     // points into the ICD document
+    int depth;
     DAInfo info;
 } DoDaEntry;
 
@@ -33,6 +54,37 @@ typedef struct {
    size_t capacity;
 } DoDaCollector;
 
+/* One DataAttribute_create call; a step's parent always comes before it */
+typedef struct {
+    const char* name;     // last element of the DA path, points into the ICD document
+    int32_t parent;       // index of the parent step, -1 = the DO itself
+    DataAttributeType type;
+    FunctionalConstraint fc;
+    uint8_t trgOps;
+} DaPlanStep;
+
+/* The DA tree of one DOType, compiled once and replayed for every DO instance */
+typedef struct {
+    DaPlanStep* steps;
+    size_t count;
+} DaPlan;
+
+/* Per-thread state for instantiating DOs */
+typedef struct {
+    ServerCtx* ctx;
+    bool compile;         // false on worker threads, which only look plans up
+    ModelNode** nodes;    // nodes created by the plan being replayed
+    size_t nodeCapacity;
+} DoBuilder;
+
+struct DaPlanCache {
+    StrIndex index;       // DOType id -> position in plans
+    DaPlan* plans;
+    size_t count;
+    size_t capacity;
+    DoBuilder builder;    // the building thread's own
+};
+
 typedef struct {
     ServerCtx* ctx;
     char hostLd[64];
@@ -41,26 +93,42 @@ typedef struct {
     DataSet* dataset;
 } DataSetBuildCtx;
 
+/* The DOs of one LN instance, filled in after all LNs exist */
+typedef struct {
+    LogicalNode* ln;
+    char lnType[64];
+    uint32_t ld;          // position in ServerCtx.lds
+} LnBuildJob;
+
 typedef struct {
     ServerCtx* ctx;
     size_t lnCount;
+    LnBuildJob* jobs;
+    size_t jobCapacity;
 } LnBuildCtx;
 
 typedef struct {
+    DoBuilder* builder;
     LogicalNode* ln;
 } LnDoBuildCtx;
 
+/* LD subtrees handed out to the build threads one LD at a time */
+typedef struct {
+    ServerCtx* ctx;
+    const LnBuildJob* jobs;
+    const size_t* order;  // job positions grouped by LD, file order within an LD
+    const size_t* ldStart;
+    size_t ldCount;
+    size_t nextLd;
+    pthread_mutex_t lock;
+} ParallelBuild;
+
 static LogicalDevice* serverctx_get_ld(ServerCtx* ctx, const char* name)
 {
-    if (!ctx || !name)
+    uint32_t pos;
+    if (!ctx || !name || !str_index_find(&ctx->ld_index, name, &pos))
         return NULL;
-    for (size_t i = 0; i < ctx->ld_count; ++i) {
-        if (strcmp(ctx->ld_cache[i].name, name) == 0)
-        {
-            return ctx->ld_cache[i].ld;
-        }
-    }
-    return NULL;
+    return ctx->lds[pos];
 }
 
 static LogicalDevice* serverctx_register_ld(ServerCtx* ctx, const char* name)
@@ -74,16 +142,19 @@ static LogicalDevice* serverctx_register_ld(ServerCtx* ctx, const char* name)
         return existing;
     }
 
+    LogicalDevice** lds = reserve_array(ctx->lds, ctx->ld_count, &ctx->ld_capacity, sizeof(*lds));
+    if (!lds) {
+        fprintf(stderr, "❌ OOM while registering LD %s\n", name);
+        return NULL;
+    }
+    ctx->lds = lds;
+
     LogicalDevice* ld = LogicalDevice_create(name, ctx->model);
     if (!ld)
         return NULL;
 
-    if (ctx->ld_count < (sizeof(ctx->ld_cache) / sizeof(ctx->ld_cache[0]))) {
-        strncpy(ctx->ld_cache[ctx->ld_count].name, name, sizeof(ctx->ld_cache[ctx->ld_count].name) - 1);
-        ctx->ld_cache[ctx->ld_count].name[sizeof(ctx->ld_cache[ctx->ld_count].name) - 1] = '\0';
-        ctx->ld_cache[ctx->ld_count].ld = ld;
-        ctx->ld_count++;
-    }
+    if (str_index_insert(&ctx->ld_index, name, (uint32_t)ctx->ld_count))
+        ctx->lds[ctx->ld_count++] = ld;
 
     return ld;
 }
@@ -131,95 +202,81 @@ static void collector_reserve(DoDaCollector* col, size_t needed) {
     col->capacity = newCap;
 }
 
-static void collector_add(DoDaCollector* col, const char* path, const DAInfo* info) {
+static int path_depth(const char* path) {
+    int depth = 0;
+    if (!path) return depth;
+    for (const char* p = path; *p; ++p)
+        if (*p == '.') depth++;
+    return depth;
+}
+
+static void collect_da_callback(const char* path, const DAInfo* info, void* ctx) {
+    DoDaCollector* col = (DoDaCollector*)ctx;
     if (!path || !info)
         return;
     collector_reserve(col, col->count + 1);
     if (col->capacity < col->count + 1)
         return;
     DoDaEntry* entry = &col->items[col->count++];
-    memset(entry, 0, sizeof(*entry));
-    strncpy(entry->path, path, sizeof(entry->path) - 1);
+    entry->path = path;
+    entry->depth = path_depth(path);
     entry->info = *info;
 }
 
-static void collect_da_callback(const char* path, const DAInfo* info, void* ctx) {
-    collector_add((DoDaCollector*)ctx, path, info);
-}
-
-static int path_depth(const char* path) {
-    int depth = 0;
-    if (!path) return depth;
-    for (const char* p = path; *p; ++p)
-        if (*p == '.') depth++;
-    return depth;
-}
-
 static int compare_entries_by_depth(const void* a, const void* b) {
     const DoDaEntry* ea = (const DoDaEntry*)a;
     const DoDaEntry* eb = (const DoDaEntry*)b;
-    int da = path_depth(ea->path);
-    int db = path_depth(eb->path);
-    if (da != db)
-        return (da < db) ? -1 : 1;
+    if (ea->depth != eb->depth)
+        return (ea->depth < eb->depth) ? -1 : 1;
     return strcmp(ea->path, eb->path);
 }
 
-static const DoDaEntry* collector_find(const DoDaCollector* col, const char* path) {
-    if (!col || !path)
-        return NULL;
-    for (size_t i = 0; i < col->count; ++i) {
-        if (strcmp(col->items[i].path, path) == 0)
-            return &col->items[i];
-    }
-    return NULL;
-}
-
-static FunctionalConstraint fc_from_string(const char* fcStr) {
-    if (!fcStr || !*fcStr)
-        return IEC61850_FC_NONE;
-    FunctionalConstraint fc = FunctionalConstraint_fromString(fcStr);
-    if (fc == IEC61850_FC_NONE)
-        fc = IEC61850_FC_ST;
-    return fc;
-}
-
-static DataAttributeType type_from_btype(const char* bType) {
-    if (!bType || !*bType)
-        return IEC61850_CONSTRUCTED;
-    if (!strcasecmp(bType, "BOOLEAN")) return IEC61850_BOOLEAN;
-    if (!strcasecmp(bType, "INT8")) return IEC61850_INT8;
-    if (!strcasecmp(bType, "INT16")) return IEC61850_INT16;
-    if (!strcasecmp(bType, "INT32")) return IEC61850_INT32;
-    if (!strcasecmp(bType, "INT64")) return IEC61850_INT64;
-    if (!strcasecmp(bType, "INT8U")) return IEC61850_INT8U;
-    if (!strcasecmp(bType, "INT16U")) return IEC61850_INT16U;
-    if (!strcasecmp(bType, "INT24U")) return IEC61850_INT24U;
-    if (!strcasecmp(bType, "INT32U")) return IEC61850_INT32U;
-    if (!strcasecmp(bType, "FLOAT32")) return IEC61850_FLOAT32;
-    if (!strcasecmp(bType, "FLOAT64")) return IEC61850_FLOAT64;
-    if (!strcasecmp(bType, "ENUM")) return IEC61850_ENUMERATED;
-    if (!strcasecmp(bType, "DBPOS")) return IEC61850_ENUMERATED;
-    if (!strcasecmp(bType, "QUALITY")) return IEC61850_QUALITY;
-    if (!strcasecmp(bType, "TIMESTAMP")) return IEC61850_TIMESTAMP;
-    if (!strcasecmp(bType, "CHECK")) return IEC61850_CHECK;
-    if (!strcasecmp(bType, "OCTET64")) return IEC61850_OCTET_STRING_64;
-    if (!strcasecmp(bType, "OCTET6")) return IEC61850_OCTET_STRING_6;
-    if (!strcasecmp(bType, "OCTET8")) return IEC61850_OCTET_STRING_8;
-    if (!strcasecmp(bType, "VISSTRING32")) return IEC61850_VISIBLE_STRING_32;
-    if (!strcasecmp(bType, "VISSTRING64")) return IEC61850_VISIBLE_STRING_64;
-    if (!strcasecmp(bType, "VISSTRING65")) return IEC61850_VISIBLE_STRING_65;
-    if (!strcasecmp(bType, "VISSTRING129")) return IEC61850_VISIBLE_STRING_129;
-    if (!strcasecmp(bType, "VISSTRING255")) return IEC61850_VISIBLE_STRING_255;
-    if (!strcasecmp(bType, "UNICODE255")) return IEC61850_UNICODE_STRING_255;
-    if (!strcasecmp(bType, "ENTRYTIME")) return IEC61850_ENTRY_TIME;
-    if (!strcasecmp(bType, "OPTFlds")) return IEC61850_OPTFLDS;
-    if (!strcasecmp(bType, "TRGOPS")) return IEC61850_TRGOPS;
-    if (!strcasecmp(bType, "OBJREF")) return IEC61850_VISIBLE_STRING_129;
-    if (!strcasecmp(bType, "STRUCT")) return IEC61850_CONSTRUCTED;
-    return IEC61850_VISIBLE_STRING_255;
-}
-
+static const FunctionalConstraint fc_from_code[ICD_FC_COUNT] = {
+    [ICD_FC_NONE] = IEC61850_FC_NONE,
+    [ICD_FC_ST] = IEC61850_FC_ST, [ICD_FC_MX] = IEC61850_FC_MX, [ICD_FC_SP] = IEC61850_FC_SP,
+    [ICD_FC_SV] = IEC61850_FC_SV, [ICD_FC_CF] = IEC61850_FC_CF, [ICD_FC_DC] = IEC61850_FC_DC,
+    [ICD_FC_SG] = IEC61850_FC_SG, [ICD_FC_SE] = IEC61850_FC_SE, [ICD_FC_SR] = IEC61850_FC_SR,
+    [ICD_FC_OR] = IEC61850_FC_OR, [ICD_FC_BL] = IEC61850_FC_BL, [ICD_FC_EX] = IEC61850_FC_EX,
+    [ICD_FC_CO] = IEC61850_FC_CO, [ICD_FC_US] = IEC61850_FC_US, [ICD_FC_MS] = IEC61850_FC_MS,
+    [ICD_FC_RP] = IEC61850_FC_RP, [ICD_FC_BR] = IEC61850_FC_BR, [ICD_FC_LG] = IEC61850_FC_LG,
+    [ICD_FC_GO] = IEC61850_FC_GO,
+    [ICD_FC_OTHER] = IEC61850_FC_ST,
+};
+
+static const DataAttributeType type_from_code[ICD_BTYPE_COUNT] = {
+    [ICD_BTYPE_NONE] = IEC61850_CONSTRUCTED,
+    [ICD_BTYPE_BOOLEAN] = IEC61850_BOOLEAN,
+    [ICD_BTYPE_INT8] = IEC61850_INT8,
+    [ICD_BTYPE_INT16] = IEC61850_INT16,
+    [ICD_BTYPE_INT32] = IEC61850_INT32,
+    [ICD_BTYPE_INT64] = IEC61850_INT64,
+    [ICD_BTYPE_INT8U] = IEC61850_INT8U,
+    [ICD_BTYPE_INT16U] = IEC61850_INT16U,
+    [ICD_BTYPE_INT24U] = IEC61850_INT24U,
+    [ICD_BTYPE_INT32U] = IEC61850_INT32U,
+    [ICD_BTYPE_FLOAT32] = IEC61850_FLOAT32,
+    [ICD_BTYPE_FLOAT64] = IEC61850_FLOAT64,
+    [ICD_BTYPE_ENUM] = IEC61850_ENUMERATED,
+    [ICD_BTYPE_DBPOS] = IEC61850_ENUMERATED,
+    [ICD_BTYPE_QUALITY] = IEC61850_QUALITY,
+    [ICD_BTYPE_TIMESTAMP] = IEC61850_TIMESTAMP,
+    [ICD_BTYPE_CHECK] = IEC61850_CHECK,
+    [ICD_BTYPE_OCTET64] = IEC61850_OCTET_STRING_64,
+    [ICD_BTYPE_OCTET6] = IEC61850_OCTET_STRING_6,
+    [ICD_BTYPE_OCTET8] = IEC61850_OCTET_STRING_8,
+    [ICD_BTYPE_VISSTRING32] = IEC61850_VISIBLE_STRING_32,
+    [ICD_BTYPE_VISSTRING64] = IEC61850_VISIBLE_STRING_64,
+    [ICD_BTYPE_VISSTRING65] = IEC61850_VISIBLE_STRING_65,
+    [ICD_BTYPE_VISSTRING129] = IEC61850_VISIBLE_STRING_129,
+    [ICD_BTYPE_VISSTRING255] = IEC61850_VISIBLE_STRING_255,
+    [ICD_BTYPE_UNICODE255] = IEC61850_UNICODE_STRING_255,
+    [ICD_BTYPE_ENTRYTIME] = IEC61850_ENTRY_TIME,
+    [ICD_BTYPE_OPTFLDS] = IEC61850_OPTFLDS,
+    [ICD_BTYPE_TRGOPS] = IEC61850_TRGOPS,
+    [ICD_BTYPE_OBJREF] = IEC61850_VISIBLE_STRING_129,
+    [ICD_BTYPE_STRUCT] = IEC61850_CONSTRUCTED,
+    [ICD_BTYPE_OTHER] = IEC61850_VISIBLE_STRING_255,
+};
 
 static LogicalDevice* get_or_create_ld(ServerCtx* ctx, const char* ldName) {
     if (!ctx)
@@ -232,89 +289,160 @@ static LogicalDevice* get_or_create_ld(ServerCtx* ctx, const char* ldName) {
     return serverctx_register_ld(ctx, canonical);
 }
 
-static LogicalNode* get_or_create_ln(LogicalDevice* ld, const char* lnName) {
-    LinkedList ch = ModelNode_getChildren((ModelNode*)ld);
-    for (LinkedList it = ch; it; it = it->next) {
-        LogicalNode* ln = (LogicalNode*) it->data;
-        if (!ln)
-            continue;
-        const char* childName = ModelNode_getName((ModelNode*)ln);
-        if (!childName)
-            continue;
-        if (strcmp(lnName, childName) == 0)
-            return ln;
+static LogicalNode* get_or_create_ln(ServerCtx* ctx, const char* ldName, const char* lnName) {
+    char canonical[64];
+    canonical_ld_name(ldName, canonical);
+    char key[160];
+    str_index_key2(key, sizeof(key), canonical, lnName);
+    uint32_t pos;
+    if (str_index_find(&ctx->ln_index, key, &pos))
+        return ctx->lns[pos];
+
+    LogicalDevice* ld = get_or_create_ld(ctx, canonical);
+    if (!ld)
+        return NULL;
+    LogicalNode** lns = reserve_array(ctx->lns, ctx->ln_count, &ctx->ln_capacity, sizeof(*lns));
+    if (!lns) {
+        fprintf(stderr, "❌ OOM while registering LN %s/%s\n", canonical, lnName);
+        return NULL;
     }
-    return LogicalNode_create(lnName, ld);
+    ctx->lns = lns;
+
+    LogicalNode* ln = LogicalNode_create(lnName, ld);
+    if (ln && str_index_insert(&ctx->ln_index, key, (uint32_t)ctx->ln_count))
+        ctx->lns[ctx->ln_count++] = ln;
+    return ln;
 }
 
-static void ensure_da_path(ModelNode* doNode, const DoDaCollector* col, const DoDaEntry* entry)
+/*
+ * Orders the DAs of a DOType parents-first and resolves each one's parent.
+ * A DA whose parent path is not part of the type is left out with its subtree.
+ */
+static bool compile_da_plan(const IcdDocument* icd, const char* doType, DaPlan* plan)
 {
-    if (!entry)
-        return;
+    DoDaCollector col = {0};
+    icd_foreach_da(icd, doType, collect_da_callback, &col);
+    plan->steps = NULL;
+    plan->count = 0;
+    if (col.count == 0) {
+        free(col.items);
+        return true;
+    }
 
-    char partial[128];
-    partial[0] = '\0';
-    ModelNode* current = doNode;
-    const char* cursor = entry->path;
-
-    while (cursor && *cursor) {
-        const char* dot = strchr(cursor, '.');
-        size_t tokenLen = dot ? (size_t)(dot - cursor) : strlen(cursor);
-        if (tokenLen >= sizeof(partial))
-            tokenLen = sizeof(partial) - 1;
-        char token[128];
-        memcpy(token, cursor, tokenLen);
-        token[tokenLen] = '\0';
-
-        if (partial[0])
-            append_token(partial, sizeof(partial), ".");
-        append_token(partial, sizeof(partial), token);
-
-        const DoDaEntry* meta = collector_find(col, partial);
-        if (!meta)
-            break;
+    qsort(col.items, col.count, sizeof(DoDaEntry), compare_entries_by_depth);
 
-        bool isLeaf = (dot == NULL);
-        DataAttributeType attrType = IEC61850_CONSTRUCTED;
-        if (!strcasecmp(meta->info.bType, "Struct"))
-            attrType = IEC61850_CONSTRUCTED;
-        else if (isLeaf)
-            attrType = type_from_btype(meta->info.bType);
-
-        ModelNode* next = ModelNode_getChild(current, token);
-        if (!next) {
-            FunctionalConstraint fc = fc_from_string(meta->info.fc);
-            next = (ModelNode*) DataAttribute_create(token, current, attrType, fc, meta->info.trgOps, 0, 0);
+    plan->steps = malloc(col.count * sizeof(DaPlanStep));
+    StrIndex byPath;
+    str_index_init(&byPath, col.count);
+    if (!plan->steps) {
+        fprintf(stderr, "❌ OOM while compiling DA plan for %s\n", doType);
+        str_index_free(&byPath);
+        free(col.items);
+        return false;
+    }
+
+    for (size_t i = 0; i < col.count; ++i) {
+        const DoDaEntry* entry = &col.items[i];
+        const char* dot = strrchr(entry->path, '.');
+        int32_t parent = -1;
+        if (dot) {
+            char parentPath[512];
+            size_t len = (size_t)(dot - entry->path);
+            uint32_t pos;
+            if (len >= sizeof(parentPath))
+                continue;
+            memcpy(parentPath, entry->path, len);
+            parentPath[len] = '\0';
+            if (!str_index_find(&byPath, parentPath, &pos))
+                continue;
+            parent = (int32_t)pos;
         }
+        if (!str_index_insert(&byPath, entry->path, (uint32_t)plan->count))
+            continue;
 
-        current = next;
-        if (!dot)
-            break;
-        cursor = dot + 1;
+        DaPlanStep* step = &plan->steps[plan->count++];
+        step->name = dot ? dot + 1 : entry->path;
+        step->parent = parent;
+        step->type = type_from_code[entry->info.bTypeCode];
+        step->fc = fc_from_code[entry->info.fcCode];
+        step->trgOps = entry->info.trgOps;
+    }
+
+    str_index_free(&byPath);
+    free(col.items);
+    return true;
+}
+
+static const DaPlan* get_da_plan(DoBuilder* builder, const char* doType)
+{
+    struct DaPlanCache* cache = builder->ctx->da_plans;
+    uint32_t pos;
+    if (str_index_find(&cache->index, doType, &pos))
+        return &cache->plans[pos];
+    if (!builder->compile)
+        return NULL;
+
+    if (cache->count == cache->capacity) {
+        size_t newCap = cache->capacity ? cache->capacity * 2 : 32;
+        DaPlan* plans = realloc(cache->plans, newCap * sizeof(DaPlan));
+        if (!plans) {
+            fprintf(stderr, "❌ OOM while caching DA plans\n");
+            return NULL;
+        }
+        cache->plans = plans;
+        cache->capacity = newCap;
     }
+
+    DaPlan* plan = &cache->plans[cache->count];
+    if (!compile_da_plan(builder->ctx->icd, doType, plan))
+        return NULL;
+    if (!str_index_insert(&cache->index, doType, (uint32_t)cache->count)) {
+        free(plan->steps);
+        return NULL;
+    }
+    cache->count++;
+    return plan;
+}
+
+static void free_da_plans(struct DaPlanCache* cache)
+{
+    for (size_t i = 0; i < cache->count; ++i)
+        free(cache->plans[i].steps);
+    free(cache->plans);
+    free(cache->builder.nodes);
+    str_index_free(&cache->index);
 }
 
-static void build_do_from_icd(ModelNode* doNode, const DOInfo* doInfo)
+static void build_do_from_icd(DoBuilder* builder, ModelNode* doNode, const DOInfo* doInfo)
 {
     if (!doNode || !doInfo)
         return;
 
-    DoDaCollector col = {0};
-    icd_foreach_da(doInfo->do_type_id, collect_da_callback, &col);
-    if (col.count == 0) {
-        free(col.items);
+    const DaPlan* plan = get_da_plan(builder, doInfo->do_type_id);
+    if (!plan)
         return;
-    }
-
-    qsort(col.items, col.count, sizeof(DoDaEntry), compare_entries_by_depth);
 
-    for (size_t i = 0; i < col.count; ++i)
-        ensure_da_path(doNode, &col, &col.items[i]);
+    if (plan->count > builder->nodeCapacity) {
+        ModelNode** grown = realloc(builder->nodes, plan->count * sizeof(ModelNode*));
+        if (!grown) {
+            fprintf(stderr, "❌ OOM while building DO of type %s\n", doInfo->do_type_id);
+            return;
+        }
+        builder->nodes = grown;
+        builder->nodeCapacity = plan->count;
+    }
 
-    free(col.items);
+    ModelNode** nodes = builder->nodes;
+    for (size_t i = 0; i < plan->count; ++i) {
+        const DaPlanStep* step = &plan->steps[i];
+        ModelNode* parent = step->parent < 0 ? doNode : nodes[step->parent];
+        nodes[i] = parent ? (ModelNode*)DataAttribute_create(step->name, parent, step->type, step->fc,
+                                                              step->trgOps, 0, 0)
+                          : NULL;
+    }
 }
 
-static ModelNode* ensure_do_from_icd(LogicalNode* ln, const char* do_name, const DOInfo* doInfo)
+static ModelNode* ensure_do_from_icd(DoBuilder* builder, LogicalNode* ln, const char* do_name, const DOInfo* doInfo)
 {
     ModelNode* existing = ModelNode_getChild((ModelNode*)ln, do_name);
     if (existing)
@@ -333,7 +461,7 @@ static ModelNode* ensure_do_from_icd(LogicalNode* ln, const char* do_name, const
         return NULL;
     }
 
-    build_do_from_icd((ModelNode*)newDo, doInfo);
+    build_do_from_icd(builder, (ModelNode*)newDo, doInfo);
     return (ModelNode*)newDo;
 }
 
@@ -343,7 +471,15 @@ static void do_build_callback(const char* doName, const DOInfo* info, void* ctx)
         return;
 
     LnDoBuildCtx* buildCtx = (LnDoBuildCtx*)ctx;
-    ensure_do_from_icd(buildCtx->ln, doName, info);
+    ensure_do_from_icd(buildCtx->builder, buildCtx->ln, doName, info);
+}
+
+static void plan_compile_callback(const char* doName, const DOInfo* info, void* ctx)
+{
+    (void)doName;
+    if (!info || !ctx)
+        return;
+    get_da_plan((DoBuilder*)ctx, info->do_type_id);
 }
 
 static void ln_instance_callback(const LNInstanceInfo* info, void* ctx)
@@ -359,17 +495,99 @@ static void ln_instance_callback(const LNInstanceInfo* info, void* ctx)
     else
         snprintf(ldName, sizeof(ldName), "LD0");
 
-    LogicalDevice* ld = get_or_create_ld(buildCtx->ctx, ldName);
     const char* lnName = info->lnName[0] ? info->lnName : "LLN0";
-    LogicalNode* ln = get_or_create_ln(ld, lnName);
-    if (!ln) {
+    LogicalNode* ln = get_or_create_ln(buildCtx->ctx, ldName, lnName);
+    uint32_t ldPos;
+    if (!ln || !str_index_find(&buildCtx->ctx->ld_index, ldName, &ldPos)) {
         return;
     }
 
-    LnDoBuildCtx doCtx = { .ln = ln };
-    icd_foreach_do(info->lnType, do_build_callback, &doCtx);
+    LnBuildJob* jobs = reserve_array(buildCtx->jobs, buildCtx->lnCount, &buildCtx->jobCapacity, sizeof(*jobs));
+    if (!jobs) {
+        fprintf(stderr, "❌ OOM while queueing LN %s/%s\n", ldName, lnName);
+        return;
+    }
+    buildCtx->jobs = jobs;
+    LnBuildJob* job = &jobs[buildCtx->lnCount++];
+    job->ln = ln;
+    snprintf(job->lnType, sizeof(job->lnType), "%s", info->lnType);
+    job->ld = ldPos;
+
+    // Worker threads only look plans up, so every plan this LN needs is compiled here
+    icd_foreach_do(buildCtx->ctx->icd, info->lnType, plan_compile_callback, &buildCtx->ctx->da_plans->builder);
+}
 
-    buildCtx->lnCount++;
+static void run_ln_job(DoBuilder* builder, const LnBuildJob* job)
+{
+    LnDoBuildCtx doCtx = { .builder = builder, .ln = job->ln };
+    icd_foreach_do(builder->ctx->icd, job->lnType, do_build_callback, &doCtx);
+}
+
+static void* ld_build_worker(void* arg)
+{
+    ParallelBuild* pb = (ParallelBuild*)arg;
+    DoBuilder builder = { .ctx = pb->ctx, .compile = false };
+    for (;;) {
+        pthread_mutex_lock(&pb->lock);
+        size_t ld = pb->nextLd++;
+        pthread_mutex_unlock(&pb->lock);
+        if (ld >= pb->ldCount)
+            break;
+        for (size_t i = pb->ldStart[ld]; i < pb->ldStart[ld + 1]; ++i)
+            run_ln_job(&builder, &pb->jobs[pb->order[i]]);
+    }
+    free(builder.nodes);
+    return NULL;
+}
+
+/*
+ * Each LD's DOs are built by a single thread in file order, so the model is
+ * the same as a serial build. Only LD subtrees are touched: the LDs and LNs
+ * already exist and all DA plans are compiled.
+ */
+static void build_lds_parallel(ServerCtx* ctx, const LnBuildJob* jobs, size_t jobCount, int threads)
+{
+    size_t ldCount = ctx->ld_count;
+    size_t* ldStart = calloc(ldCount + 1, sizeof(size_t));
+    size_t* fill = calloc(ldCount, sizeof(size_t));
+    size_t* order = malloc((jobCount ? jobCount : 1) * sizeof(size_t));
+    pthread_t* tids = malloc((size_t)threads * sizeof(pthread_t));
+    if (!ldStart || !fill || !order || !tids) {
+        fprintf(stderr, "❌ OOM while scheduling the parallel build, building serially\n");
+        for (size_t i = 0; i < jobCount; ++i)
+            run_ln_job(&ctx->da_plans->builder, &jobs[i]);
+        free(ldStart);
+        free(fill);
+        free(order);
+        free(tids);
+        return;
+    }
+
+    for (size_t i = 0; i < jobCount; ++i)
+        ldStart[jobs[i].ld + 1]++;
+    for (size_t ld = 0; ld < ldCount; ++ld)
+        ldStart[ld + 1] += ldStart[ld];
+    for (size_t i = 0; i < jobCount; ++i)
+        order[ldStart[jobs[i].ld] + fill[jobs[i].ld]++] = i;
+
+    ParallelBuild pb = { .ctx = ctx, .jobs = jobs, .order = order, .ldStart = ldStart, .ldCount = ldCount };
+    pthread_mutex_init(&pb.lock, NULL);
+
+    int started = 0;
+    for (int t = 1; t < threads && (size_t)t < ldCount; ++t) {
+        if (pthread_create(&tids[started], NULL, ld_build_worker, &pb) != 0)
+            break;
+        started++;
+    }
+    ld_build_worker(&pb);
+    for (int t = 0; t < started; ++t)
+        pthread_join(tids[t], NULL);
+
+    pthread_mutex_destroy(&pb.lock);
+    free(fill);
+    free(order);
+    free(ldStart);
+    free(tids);
 }
 
 static void ld_precreate_callback(const LNInstanceInfo* info, void* ctx)
@@ -414,8 +632,6 @@ static void dataset_member_callback(const FCDAInfo* info, void* ctx)
         targetLd[sizeof(targetLd) - 1] = '\0';
     }
 
-    LogicalDevice* ld = get_or_create_ld(dctx->ctx, targetLd);
-
     char targetLn[64];
     if (info->lnClass[0] || info->lnInst[0] || info->prefix[0]) {
         compose_ln_from_parts(info->prefix, info->lnClass, info->lnInst, targetLn);
@@ -429,18 +645,19 @@ static void dataset_member_callback(const FCDAInfo* info, void* ctx)
         targetLn[sizeof(targetLn) - 1] = '\0';
     }
 
-    LogicalNode* ln = get_or_create_ln(ld, targetLn);
+    LogicalNode* ln = get_or_create_ln(dctx->ctx, targetLd, targetLn);
 
     char targetLnType[64] = {0};
-    if (!icd_find_ln_type_by_parts(targetLd, info->prefix, info->lnClass, info->lnInst, targetLnType))
-        icd_find_ln_type_by_name(targetLd, targetLn, targetLnType);
+    const IcdDocument* icd = dctx->ctx->icd;
+    if (!icd_find_ln_type_by_parts(icd, dctx->ctx->ied_name, targetLd, info->prefix, info->lnClass, info->lnInst, targetLnType))
+        icd_find_ln_type_by_name(icd, dctx->ctx->ied_name, targetLd, targetLn, targetLnType);
     if (!targetLnType[0] && strcmp(targetLd, dctx->hostLd) == 0 && strcmp(targetLn, dctx->hostLn) == 0)
         snprintf(targetLnType, sizeof(targetLnType), "%s", dctx->hostLnType);
 
     if (info->doName[0]) {
         DOInfo di = {0};
-        if (targetLnType[0] && icd_find_do_info(targetLnType, info->doName, &di))
-            ensure_do_from_icd(ln, info->doName, &di);
+        if (targetLnType[0] && icd_find_do_info(icd, targetLnType, info->doName, &di))
+            ensure_do_from_icd(&dctx->ctx->da_plans->builder, ln, info->doName, &di);
     }
 
     char variable[256];
@@ -485,8 +702,7 @@ static void dataset_callback(const char* ldInst, const char* lnName, const char*
     else
         snprintf(hostLn, sizeof(hostLn), "LLN0");
 
-    LogicalDevice* ld = get_or_create_ld(server, hostLd);
-    LogicalNode* ln = get_or_create_ln(ld, hostLn);
+    LogicalNode* ln = get_or_create_ln(server, hostLd, hostLn);
     DataSet* ds = DataSet_create(dsName, ln);
     if (!ds)
         return;
@@ -496,18 +712,18 @@ static void dataset_callback(const char* ldInst, const char* lnName, const char*
     buildCtx.ctx = server;
     snprintf(buildCtx.hostLd, sizeof(buildCtx.hostLd), "%s", hostLd);
     snprintf(buildCtx.hostLn, sizeof(buildCtx.hostLn), "%s", hostLn);
-    if (!icd_find_ln_type_by_name(hostLd, hostLn, buildCtx.hostLnType))
+    if (!icd_find_ln_type_by_name(server->icd, server->ied_name, hostLd, hostLn, buildCtx.hostLnType))
         buildCtx.hostLnType[0] = '\0';
     buildCtx.dataset = ds;
 
-    icd_foreach_dataset_fcda(ldInst, lnName, dsName, dataset_member_callback, &buildCtx);
+    icd_foreach_dataset_fcda(server->icd, server->ied_name, ldInst, lnName, dsName, dataset_member_callback, &buildCtx);
 }
 
 static void create_datasets(ServerCtx* ctx)
 {
     if (!ctx || !ctx->model)
         return;
-    icd_foreach_dataset(dataset_callback, ctx);
+    icd_foreach_dataset(ctx->icd, ctx->ied_name, dataset_callback, ctx);
 }
 
 static void report_callback(const ReportControlInfo* info, void* ctx)
@@ -519,12 +735,8 @@ static void report_callback(const ReportControlInfo* info, void* ctx)
 
     char ldName[64];
     canonical_ld_name(info->ldInst, ldName);
-    LogicalDevice* ld = get_or_create_ld(server, ldName);
-    if (!ld)
-        return;
-
     const char* lnName = (info->lnName[0]) ? info->lnName : "LLN0";
-    LogicalNode* ln = get_or_create_ln(ld, lnName);
+    LogicalNode* ln = get_or_create_ln(server, ldName, lnName);
     if (!ln)
         return;
 
@@ -562,58 +774,689 @@ static void create_reports(ServerCtx* ctx)
 {
     if (!ctx || !ctx->model)
         return;
-    icd_foreach_report(report_callback, ctx);
+    icd_foreach_report(ctx->icd, ctx->ied_name, report_callback, ctx);
 }
 
 /* ---------- Build the dynamic model using the ICD data ---------- */
 
-int build_model_from_icd(ServerCtx* ctx)
+int build_model_from_icd(ServerCtx* ctx, const IcdDocument* icd, const char* iedName)
 {
-    if (!ctx)
+    if (!ctx || !icd)
         return -1;
 
-    const char* iedName = icd_get_selected_ied_name();
+    ctx->icd = icd;
     if (!iedName || !*iedName)
-        iedName = "DYN_IED";
+        iedName = icd_get_selected_ied_name(icd);
+    snprintf(ctx->ied_name, sizeof(ctx->ied_name), "%s", iedName ? iedName : "");
+    const char* modelName = ctx->ied_name[0] ? ctx->ied_name : "DYN_IED";
 
-    ctx->model = IedModel_create(iedName);
-    IedModel_setIedNameForDynamicModel(ctx->model, iedName);
+    ctx->model = IedModel_create(modelName);
+    IedModel_setIedNameForDynamicModel(ctx->model, modelName);
 
+    str_index_init(&ctx->ld_index, 16);
+    str_index_init(&ctx->ln_index, 256);
     ctx->ld_count = 0;
-    icd_foreach_ln_instance(ld_precreate_callback, ctx);
+    ctx->ln_count = 0;
+    icd_foreach_ln_instance(icd, ctx->ied_name, ld_precreate_callback, ctx);
 
+    struct DaPlanCache plans = {0};
+    str_index_init(&plans.index, 64);
+    plans.builder.ctx = ctx;
+    plans.builder.compile = true;
+    ctx->da_plans = &plans;
+
+    // LNs are created first in file order, their DOs afterwards, serially or one LD per thread
     LnBuildCtx lnCtx = { .ctx = ctx, .lnCount = 0 };
-    icd_foreach_ln_instance(ln_instance_callback, &lnCtx);
+    icd_foreach_ln_instance(icd, ctx->ied_name, ln_instance_callback, &lnCtx);
+    if (ctx->build_threads > 1 && ctx->ld_count > 1) {
+        build_lds_parallel(ctx, lnCtx.jobs, lnCtx.lnCount, ctx->build_threads);
+    }
+    else {
+        for (size_t i = 0; i < lnCtx.lnCount; ++i)
+            run_ln_job(&plans.builder, &lnCtx.jobs[i]);
+    }
+    free(lnCtx.jobs);
 
     create_datasets(ctx);
     create_reports(ctx);
+    index_model_attributes(ctx);
+
+    fprintf(stdout, "ICD build summary: logical-nodes=%zu DOType-plans=%zu attributes=%zu\n", lnCtx.lnCount,
+            plans.count, ctx->attr_count);
+
+    ctx->da_plans = NULL;
+    free_da_plans(&plans);
+
+    return 0;
+}
+
+#endif /* STATIC_MODEL */
+
+/* ---------- Attribute handles ---------- */
+
+static bool register_attribute(ServerCtx* ctx, DataAttribute* da, const char* ref)
+{
+    DataAttribute** attrs = reserve_array(ctx->attrs, ctx->attr_count, &ctx->attr_capacity, sizeof(*attrs));
+    if (!attrs)
+        return false;
+    ctx->attrs = attrs;
+    if (!str_index_insert(&ctx->attr_index, ref, (uint32_t)ctx->attr_count))
+        return str_index_find(&ctx->attr_index, ref, NULL); // duplicate reference keeps the first id
+    ctx->attrs[ctx->attr_count++] = da;
+    return true;
+}
+
+// ref holds the reference of node (len chars); children are appended in place
+static bool index_children(ServerCtx* ctx, ModelNode* node, char* ref, size_t len, size_t size)
+{
+    for (ModelNode* child = node->firstChild; child; child = child->sibling) {
+        int n;
+        if (child->name)
+            n = snprintf(ref + len, size - len, "%s%s", len && ref[len - 1] != '/' ? "." : "", child->name);
+        else if (child->modelType == DataAttributeModelType)
+            n = snprintf(ref + len, size - len, "(%d)", ((DataAttribute*)child)->arrayIndex);
+        else
+            n = snprintf(ref + len, size - len, "(%d)", ((DataObject*)child)->arrayIndex);
+        if (n < 0 || (size_t)n >= size - len) {
+            ref[len] = '\0';
+            fprintf(stderr, "⚠️ Reference below %s too long, attributes not indexed\n", ref);
+            continue;
+        }
+
+        bool ok;
+        if (child->modelType == DataAttributeModelType && !child->firstChild)
+            ok = register_attribute(ctx, (DataAttribute*)child, ref);
+        else
+            ok = index_children(ctx, child, ref, len + (size_t)n, size);
+        if (!ok)
+            return false;
+    }
+    ref[len] = '\0';
+    return true;
+}
 
-    fprintf(stdout, "ICD build summary: logical-nodes=%zu\n", lnCtx.lnCount);
+static size_t count_leaves(ModelNode* node)
+{
+    size_t count = 0;
+    for (ModelNode* child = node->firstChild; child; child = child->sibling)
+        count += child->modelType == DataAttributeModelType && !child->firstChild ? 1 : count_leaves(child);
+    return count;
+}
+
+int index_model_attributes(ServerCtx* ctx)
+{
+    if (!ctx || !ctx->model)
+        return -1;
 
+    // Sized up front: a quarter million leaves are common and the index would otherwise run at full load
+    size_t leaves = 0;
+    for (LogicalDevice* ld = ctx->model->firstChild; ld; ld = (LogicalDevice*)ld->sibling)
+        leaves += count_leaves((ModelNode*)ld);
+    str_index_free(&ctx->attr_index);
+    str_index_init(&ctx->attr_index, leaves);
+    ctx->attr_count = 0;
+
+    char ref[256];
+    for (LogicalDevice* ld = ctx->model->firstChild; ld; ld = (LogicalDevice*)ld->sibling) {
+        int n = snprintf(ref, sizeof(ref), "%s/", ld->name);
+        if (n < 0 || (size_t)n >= sizeof(ref) || !index_children(ctx, (ModelNode*)ld, ref, (size_t)n, sizeof(ref))) {
+            fprintf(stderr, "❌ Failed to index the attributes of LD %s\n", ld->name);
+            return -1;
+        }
+    }
     return 0;
 }
 
+uint32_t serverctx_find_attr(const ServerCtx* ctx, const char* ref)
+{
+    uint32_t id;
+    if (!ctx || !ref || !str_index_find(&ctx->attr_index, ref, &id))
+        return ATTR_ID_NONE;
+    return id;
+}
+
+/* ---------- Batched attribute updates ---------- */
+
+void attr_batch_init(AttrUpdateBatch* batch)
+{
+    memset(batch, 0, sizeof(*batch));
+}
+
+void attr_batch_free(AttrUpdateBatch* batch)
+{
+    free(batch->items);
+    free(batch->applied);
+    memset(batch, 0, sizeof(*batch));
+}
+
+bool attr_batch_add(AttrUpdateBatch* batch, const AttrUpdate* update)
+{
+    AttrUpdate* items = reserve_array(batch->items, batch->count, &batch->capacity, sizeof(*items));
+    if (!items)
+        return false;
+    batch->items = items;
+    uint32_t* applied = reserve_array(batch->applied, batch->count, &batch->appliedCapacity, sizeof(*applied));
+    if (!applied)
+        return false;
+    batch->applied = applied;
+    batch->items[batch->count++] = *update;
+    return true;
+}
+
+// q and t belong to the innermost data object above the attribute
+static DataAttribute* sibling_status_attr(DataAttribute* da, const char* name)
+{
+    ModelNode* node = da->parent;
+    while (node && node->modelType != DataObjectModelType)
+        node = node->parent;
+    if (!node)
+        return NULL;
+    ModelNode* child = ModelNode_getChild(node, name);
+    return child && child->modelType == DataAttributeModelType ? (DataAttribute*)child : NULL;
+}
+
+static void apply_update(IedServer server, DataAttribute* da, const AttrUpdate* update)
+{
+    // Timestamp and quality first, so a report triggered by the value carries them
+    if (update->timestampMs) {
+        DataAttribute* t = sibling_status_attr(da, "t");
+        if (t)
+            IedServer_updateUTCTimeAttributeValue(server, t, update->timestampMs);
+    }
+    if (update->hasQuality) {
+        DataAttribute* q = sibling_status_attr(da, "q");
+        if (q)
+            IedServer_updateQuality(server, q, update->quality);
+    }
+
+    switch (update->kind) {
+    case ATTR_VALUE_BOOL:
+        IedServer_updateBooleanAttributeValue(server, da, update->value.b);
+        break;
+    case ATTR_VALUE_INT32:
+        IedServer_updateInt32AttributeValue(server, da, update->value.i);
+        break;
+    case ATTR_VALUE_UINT32:
+        IedServer_updateUnsignedAttributeValue(server, da, update->value.u);
+        break;
+    case ATTR_VALUE_FLOAT:
+        IedServer_updateFloatAttributeValue(server, da, update->value.f);
+        break;
+    case ATTR_VALUE_DBPOS:
+        IedServer_updateDbposValue(server, da, update->value.dbpos);
+        break;
+    case ATTR_VALUE_MMS:
+        if (update->value.mms)
+            IedServer_updateAttributeValue(server, da, update->value.mms);
+        break;
+    }
+}
+
+size_t serverctx_apply_batch(ServerCtx* ctx, AttrUpdateBatch* batch)
+{
+    if (!ctx || !batch || batch->count == 0)
+        return 0;
+    if (!ctx->server) {
+        fprintf(stderr, "⚠️ Attribute batch dropped: server not started\n");
+        batch->count = 0;
+        return 0;
+    }
+
+    size_t applied = 0;
+    IedServer_lockDataModel(ctx->server);
+    for (size_t i = 0; i < batch->count; ++i) {
+        DataAttribute* da = serverctx_attr(ctx, batch->items[i].id);
+        if (!da)
+            continue;
+        apply_update(ctx->server, da, &batch->items[i]);
+        batch->applied[applied++] = batch->items[i].id;
+    }
+    IedServer_unlockDataModel(ctx->server);
+    report_sched_data_changed(ctx->reports, batch->applied, applied, Hal_getTimeInMs());
+
+    batch->count = 0;
+    return applied;
+}
+
+void release_server_ctx(ServerCtx* ctx)
+{
+    if (!ctx)
+        return;
+    report_sched_destroy(ctx->reports);
+    if (ctx->server)
+        IedServer_destroy(ctx->server);
+    if (ctx->model && !ctx->static_model)
+        IedModel_destroy(ctx->model);
+    str_index_free(&ctx->ld_index);
+    str_index_free(&ctx->ln_index);
+    str_index_free(&ctx->attr_index);
+    free(ctx->lds);
+    free(ctx->lns);
+    free(ctx->attrs);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+/* ---------- Report datasets ---------- */
+
+#define WATCH_NONE UINT32_MAX
+
+/*
+ * Maps dataset members to the RCBs that report them. A member ("LD/LN.DO.DA"
+ * and FC) may appear in several datasets, and a dataset may have several
+ * RCBs; both are chained through arrays.
+ */
+typedef struct {
+    StrIndex dataSetIndex;    // "LD/LN$DS" -> dataset position
+    uint32_t* firstRcb;       // per dataset
+    ReportControlBlock** rcbs;
+    uint32_t* nextRcb;
+    StrIndex memberIndex;     // member reference \x1f FC -> member key position
+    uint32_t* firstMember;    // per member key, first (dataset, next) pair
+    size_t memberKeyCapacity;
+    uint32_t* memberDataSet;
+    uint32_t* nextMember;
+    size_t memberCount;
+    size_t memberCapacity;
+} DataSetWatch;
+
+static void data_set_watch_free(DataSetWatch* w)
+{
+    str_index_free(&w->dataSetIndex);
+    str_index_free(&w->memberIndex);
+    free(w->firstRcb);
+    free(w->rcbs);
+    free(w->nextRcb);
+    free(w->firstMember);
+    free(w->memberDataSet);
+    free(w->nextMember);
+}
+
+static const char* member_key(char* buf, size_t size, const char* ref, size_t refLen, int fc)
+{
+    int n = snprintf(buf, size, "%.*s\x1f%d", (int)refLen, ref, fc);
+    return n >= 0 && (size_t)n < size ? buf : NULL;
+}
+
+static bool add_member(DataSetWatch* w, const char* key, uint32_t dataSet)
+{
+    uint32_t keyPos = str_index_intern(&w->memberIndex, key);
+    if (keyPos == UINT32_MAX)
+        return false;
+    if (keyPos >= w->memberKeyCapacity) {
+        size_t capacity = w->memberKeyCapacity;
+        uint32_t* first = reserve_array(w->firstMember, keyPos, &w->memberKeyCapacity, sizeof(uint32_t));
+        if (!first)
+            return false;
+        w->firstMember = first;
+        for (size_t i = capacity; i < w->memberKeyCapacity; ++i)
+            w->firstMember[i] = WATCH_NONE;
+    }
+    size_t capacity = w->memberCapacity;
+    uint32_t* dataSets = reserve_array(w->memberDataSet, w->memberCount, &capacity, sizeof(uint32_t));
+    if (dataSets)
+        w->memberDataSet = dataSets;
+    uint32_t* next = dataSets ? reserve_array(w->nextMember, w->memberCount, &w->memberCapacity, sizeof(uint32_t)) : NULL;
+    if (!next)
+        return false;
+    w->nextMember = next;
+    w->memberDataSet[w->memberCount] = dataSet;
+    w->nextMember[w->memberCount] = w->firstMember[keyPos];
+    w->firstMember[keyPos] = (uint32_t)w->memberCount++;
+    return true;
+}
+
+// "LN$FC$DO$DA" of a dataset entry as the attribute reference "LD/LN.DO.DA" and its FC
+static bool entry_member_key(char* buf, size_t size, const DataSet* ds, const DataSetEntry* e)
+{
+    const char* ld = e->logicalDeviceName ? e->logicalDeviceName : ds->logicalDeviceName;
+    const char* fcStart = strchr(e->variableName, '$');
+    if (!ld || !fcStart)
+        return false;
+    char fcName[4] = {0};
+    const char* rest = strchr(fcStart + 1, '$');
+    size_t fcLen = rest ? (size_t)(rest - fcStart - 1) : strlen(fcStart + 1);
+    if (fcLen == 0 || fcLen >= sizeof(fcName))
+        return false;
+    memcpy(fcName, fcStart + 1, fcLen);
+
+    char ref[256];
+    int n = snprintf(ref, sizeof(ref), "%s/%.*s", ld, (int)(fcStart - e->variableName), e->variableName);
+    for (const char* p = rest; p && *p && n >= 0 && (size_t)n < sizeof(ref); ++p)
+        ref[n++] = *p == '$' ? '.' : *p;
+    if (n >= 0 && (size_t)n < sizeof(ref))
+        ref[n] = '\0';
+    if (n >= 0 && (size_t)n < sizeof(ref) && e->index >= 0)
+        n += snprintf(ref + n, sizeof(ref) - (size_t)n, "(%d)", e->index);
+    if (n >= 0 && (size_t)n < sizeof(ref) && e->componentName)
+        n += snprintf(ref + n, sizeof(ref) - (size_t)n, ".%s", e->componentName);
+    if (n < 0 || (size_t)n >= sizeof(ref))
+        return false;
+    return member_key(buf, size, ref, (size_t)n, (int)FunctionalConstraint_fromString(fcName)) != NULL;
+}
+
+static bool collect_report_datasets(DataSetWatch* w, IedModel* model)
+{
+    size_t dsCount = 0, rcbCount = 0;
+    for (DataSet* ds = model->dataSets; ds; ds = ds->sibling)
+        dsCount++;
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling)
+        rcbCount++;
+    str_index_init(&w->dataSetIndex, dsCount);
+    str_index_init(&w->memberIndex, 256);
+    w->firstRcb = malloc((dsCount + 1) * sizeof(uint32_t));
+    w->rcbs = malloc((rcbCount + 1) * sizeof(ReportControlBlock*));
+    w->nextRcb = malloc((rcbCount + 1) * sizeof(uint32_t));
+    if (!w->firstRcb || !w->rcbs || !w->nextRcb)
+        return false;
+
+    char ref[256];
+    uint32_t pos = 0;
+    DataSet** dataSets = malloc((dsCount + 1) * sizeof(DataSet*));
+    if (!dataSets)
+        return false;
+    for (DataSet* ds = model->dataSets; ds; ds = ds->sibling, ++pos) {
+        dataSets[pos] = ds;
+        w->firstRcb[pos] = WATCH_NONE;
+        int n = snprintf(ref, sizeof(ref), "%s/%s", ds->logicalDeviceName ? ds->logicalDeviceName : "", ds->name);
+        if (n > 0 && (size_t)n < sizeof(ref))
+            str_index_insert(&w->dataSetIndex, ref, pos); // a duplicate keeps the first dataset
+    }
+
+    // Datasets without an RCB need no members
+    size_t n = 0;
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling) {
+        const char* name = rcb->dataSetName;
+        LogicalNode* ln = rcb->parent;
+        if (!name)
+            continue;
+        int len = strchr(name, '/') || !ln || !ln->parent
+                      ? snprintf(ref, sizeof(ref), "%s", name)
+                      : snprintf(ref, sizeof(ref), "%s/%s", ln->parent->name, name);
+        uint32_t ds;
+        if (len < 0 || (size_t)len >= sizeof(ref) || !str_index_find(&w->dataSetIndex, ref, &ds)) {
+            fprintf(stderr, "⚠️ Dataset %s of RCB %s not in the model\n", name, rcb->name);
+            continue;
+        }
+        w->rcbs[n] = rcb;
+        w->nextRcb[n] = w->firstRcb[ds];
+        w->firstRcb[ds] = (uint32_t)n++;
+    }
+
+    bool ok = true;
+    for (uint32_t ds = 0; ok && ds < dsCount; ++ds) {
+        if (w->firstRcb[ds] == WATCH_NONE)
+            continue;
+        for (DataSetEntry* e = dataSets[ds]->fcdas; ok && e; e = e->sibling) {
+            char key[288];
+            if (!entry_member_key(key, sizeof(key), dataSets[ds], e))
+                fprintf(stderr, "⚠️ Member %s of dataset %s not mapped to attributes\n", e->variableName,
+                        dataSets[ds]->name);
+            else
+                ok = add_member(w, key, ds);
+        }
+    }
+    free(dataSets);
+    return ok;
+}
+
+/*
+ * Tells the report scheduler which RCBs each leaf attribute can trigger, so a
+ * change only starts the buffer time of RCBs whose dataset contains it. A
+ * member covers the leaf with its reference and FC and every leaf below it.
+ * Must run before the server is created: the SDK reuses rcb->sibling.
+ */
+static void watch_report_datasets(ServerCtx* ctx)
+{
+    DataSetWatch w = {0};
+    if (!collect_report_datasets(&w, ctx->model)) {
+        fprintf(stderr, "⚠️ OOM mapping report datasets, buffer times start only on the idle tick\n");
+        data_set_watch_free(&w);
+        return;
+    }
+
+    for (uint32_t id = 0; w.memberCount && id < ctx->attr_count; ++id) {
+        const char* ref = str_index_key_at(&ctx->attr_index, id);
+        const char* slash = ref ? strchr(ref, '/') : NULL;
+        if (!slash)
+            continue;
+        int fc = (int)ctx->attrs[id]->fc;
+        size_t len = strlen(ref);
+        // Every node above the leaf, down to the data object, may be a dataset member
+        for (size_t cut = len; cut > (size_t)(slash - ref); --cut) {
+            if (cut != len && ref[cut] != '.' && ref[cut] != '(')
+                continue;
+            char key[288];
+            uint32_t keyPos;
+            if (!member_key(key, sizeof(key), ref, cut, fc) || !str_index_find(&w.memberIndex, key, &keyPos))
+                continue;
+            for (uint32_t m = w.firstMember[keyPos]; m != WATCH_NONE; m = w.nextMember[m]) {
+                for (uint32_t r = w.firstRcb[w.memberDataSet[m]]; r != WATCH_NONE; r = w.nextRcb[r])
+                    report_sched_watch(ctx->reports, w.rcbs[r], id);
+            }
+        }
+    }
+    data_set_watch_free(&w);
+}
+
 /* ---------- Server bootstrap and processing loop ---------- */
 
-int start_server(ServerCtx* ctx, int tcp_port) {
-    ctx->server = IedServer_create(ctx->model);
+/*
+ * Report timers wake the loop exactly when due (report_sched.c). This tick
+ * covers the SDK's other periodic work, such as select-before-operate
+ * timeouts. Buffer times started by MMS writes or controls are not seen by
+ * the scheduler, so while an RCB with a buffer time is enabled the tick
+ * shrinks to the smallest enabled bufTm.
+ */
+#define SERVER_IDLE_TICK_MS 100
+
+/* ---------- Thread placement ---------- */
+
+typedef struct {
+    cpu_set_t cpus;
+    int policy;
+    struct sched_param param;
+} ThreadPlacement;
+
+static void placement_save(ThreadPlacement* base)
+{
+    pthread_t self = pthread_self();
+    if (pthread_getaffinity_np(self, sizeof(base->cpus), &base->cpus) != 0) {
+        CPU_ZERO(&base->cpus);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            CPU_SET(cpu, &base->cpus);
+    }
+    if (pthread_getschedparam(self, &base->policy, &base->param) != 0) {
+        base->policy = SCHED_OTHER;
+        base->param.sched_priority = 0;
+    }
+}
+
+/*
+ * Gives the calling thread ctx's CPUs and priority, or base where ctx sets
+ * none. Threads inherit both from their creator, so this runs before the
+ * server and its loop thread are started.
+ */
+static void placement_apply(const ServerCtx* ctx, const ThreadPlacement* base)
+{
+    pthread_t self = pthread_self();
+    cpu_set_t cpus = base->cpus;
+    if (ctx->cpu_mask) {
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < 64; ++cpu) {
+            if (ctx->cpu_mask & (UINT64_C(1) << cpu))
+                CPU_SET(cpu, &cpus);
+        }
+    }
+    int rc = pthread_setaffinity_np(self, sizeof(cpus), &cpus);
+    if (rc != 0 && ctx->cpu_mask)
+        fprintf(stderr, "⚠️ Cannot pin %s to CPU mask 0x%llx: %s\n", ctx->ied_name,
+                (unsigned long long)ctx->cpu_mask, strerror(rc));
+
+    int policy = base->policy;
+    struct sched_param param = base->param;
+    if (ctx->rt_priority > 0) {
+        policy = SCHED_FIFO;
+        param.sched_priority = ctx->rt_priority;
+    }
+    rc = pthread_setschedparam(self, policy, &param);
+    if (rc != 0 && ctx->rt_priority > 0)
+        fprintf(stderr, "⚠️ Cannot run %s at SCHED_FIFO priority %d: %s%s\n", ctx->ied_name, ctx->rt_priority,
+                strerror(rc), rc == EPERM ? " (needs CAP_SYS_NICE)" : "");
+}
+
+static int open_server(ServerCtx* ctx, int tcp_port)
+{
+    // The threadless loop mirrors the report timers; the RCB list must be read before the server exists
+    if (ctx->server_threads <= 0) {
+        ctx->reports = report_sched_create(ctx->model, ctx->attr_count);
+        if (ctx->reports)
+            watch_report_datasets(ctx);
+        else
+            fprintf(stderr, "⚠️ No report scheduler, periodic tasks run every %d ms only\n", SERVER_IDLE_TICK_MS);
+    }
+
+    if (ctx->server_threads > 0) {
+        IedServerConfig config = IedServerConfig_create();
+        IedServerConfig_setMaxMmsConnections(config, ctx->server_threads);
+        ctx->server = IedServer_createWithConfig(ctx->model, NULL, config);
+        IedServerConfig_destroy(config);
+    }
+    else {
+        ctx->server = IedServer_create(ctx->model);
+    }
     IedServer_setServerIdentity(ctx->server, "Dyn-CSV+ICD", "HLK7688A", "v0.3");
-    IedServer_startThreadless(ctx->server, tcp_port);
+    if (ctx->local_ip[0])
+        IedServer_setLocalIpAddress(ctx->server, ctx->local_ip);
+    if (ctx->server_threads > 0)
+        IedServer_start(ctx->server, tcp_port);
+    else
+        IedServer_startThreadless(ctx->server, tcp_port);
 
+    const char* address = ctx->local_ip[0] ? ctx->local_ip : "*";
     if (!IedServer_isRunning(ctx->server)) {
-        fprintf(stderr, "❌ Failed to start MMS server on port %d\n", tcp_port);
+        fprintf(stderr, "❌ Failed to start MMS server for %s on %s:%d\n", ctx->ied_name, address, tcp_port);
         return -1;
     }
 
-    printf("✅ MMS server listening on TCP %d ...\n", tcp_port);
-    while (1) {
-        IedServer_processIncomingData(ctx->server);
-        IedServer_performPeriodicTasks(ctx->server);
-        usleep(50 * 1000);
+    if (ctx->server_threads > 0) {
+        // The SDK serves each connection on its own thread; updates go through serverctx_apply_batch
+        printf("✅ MMS server %s listening on %s:%d (threaded, up to %d connections) ...\n", ctx->ied_name,
+               address, tcp_port, ctx->server_threads);
+        return 0;
     }
+
+    printf("✅ MMS server %s listening on %s:%d ...\n", ctx->ied_name, address, tcp_port);
+    if (ctx->reports)
+        report_sched_attach(ctx->reports, ctx->server);
     return 0;
 }
 
+// Threadless servers are driven here; the SDK's threads drive the others
+static void run_server(ServerCtx* ctx)
+{
+    if (ctx->server_threads > 0) {
+        while (!atomic_load(&ctx->stop) && IedServer_isRunning(ctx->server))
+            sleep(1);
+        return;
+    }
+
+    // Sleep in the SDK's socket wait until a request arrives or the next report deadline is due
+    uint64_t lastPeriodic = Hal_getTimeInMs();
+    while (!atomic_load(&ctx->stop)) {
+        uint64_t now = Hal_getTimeInMs();
+        uint64_t nextIdle = lastPeriodic + report_sched_idle_tick(ctx->reports, SERVER_IDLE_TICK_MS);
+        uint64_t wake = report_sched_next_deadline(ctx->reports);
+        if (wake > nextIdle)
+            wake = nextIdle;
+        unsigned int timeoutMs = wake > now ? (unsigned int)(wake - now) : 0;
+        if (IedServer_waitReady(ctx->server, timeoutMs) > 0)
+            IedServer_processIncomingData(ctx->server);
+
+        now = Hal_getTimeInMs();
+        if (report_sched_run_due(ctx->reports, now)) {
+            lastPeriodic = now;
+        }
+        else if (now >= nextIdle) {
+            IedServer_performPeriodicTasks(ctx->server);
+            lastPeriodic = now;
+        }
+    }
+}
+
+static void* server_thread(void* arg)
+{
+    run_server(arg);
+    return NULL;
+}
+
+// Only once its loop has returned
+static void stop_server(ServerCtx* ctx)
+{
+    if (!ctx->server || !IedServer_isRunning(ctx->server))
+        return;
+    if (ctx->server_threads > 0)
+        IedServer_stop(ctx->server);
+    else
+        IedServer_stopThreadless(ctx->server);
+}
+
+int start_server(ServerCtx* ctx, int tcp_port) {
+    ThreadPlacement base;
+    placement_save(&base);
+    placement_apply(ctx, &base);
+    if (open_server(ctx, tcp_port) != 0)
+        return -1;
+    run_server(ctx);
+    stop_server(ctx);
+    return 0;
+}
+
+int start_servers(ServerCtx* ctxs, const int* tcp_ports, size_t count)
+{
+    if (!ctxs || count == 0)
+        return -1;
+    pthread_t* threads = calloc(count, sizeof(pthread_t));
+    if (!threads)
+        return -1;
+
+    int rc = 0;
+    ThreadPlacement base;
+    placement_save(&base);
+    size_t opened = 0;
+    for (; opened < count; ++opened) {
+        placement_apply(&ctxs[opened], &base);
+        if (open_server(&ctxs[opened], tcp_ports[opened]) != 0) {
+            rc = -1;
+            break;
+        }
+    }
+
+    // One loop thread per further IED; each sleeps in its own server's socket wait
+    size_t started = 1;
+    for (; rc == 0 && started < count; ++started) {
+        placement_apply(&ctxs[started], &base);
+        if (pthread_create(&threads[started], NULL, server_thread, &ctxs[started]) != 0) {
+            fprintf(stderr, "❌ Cannot start the server thread of %s\n", ctxs[started].ied_name);
+            rc = -1;
+            break;
+        }
+    }
+    if (rc == 0) {
+        placement_apply(&ctxs[0], &base);
+        run_server(&ctxs[0]);
+    }
+
+    // The caller releases the ctxs, so every loop has to return and every server to stop first
+    for (size_t i = 0; i < count; ++i)
+        atomic_store(&ctxs[i].stop, true);
+    for (size_t i = 1; i < started; ++i)
+        pthread_join(threads[i], NULL);
+    for (size_t i = 0; i < opened; ++i)
+        stop_server(&ctxs[i]);
+    free(threads);
+    return rc;
+}
+
 /* ---------- Debug helper: dump the model tree ---------- */
 
 /* Print the model tree so it can be compared with IEDScout */
@@ -7,18 +7,109 @@
  * Description: Declarations for building the dynamic IEC 61850 model and running the server.
  */
 
+#include <stdatomic.h>
+
 #include "iec61850_server.h"
+#include "icd_parser.h"
+#include "str_index.h"
 
 typedef struct {
+    const IcdDocument* icd;   // source of the model, owned by the caller
+    char ied_name[64];        // IED of icd the model was built from
     IedModel* model;
+    bool static_model;        // model is compiled in and never destroyed
     IedServer server;
-    struct {
-        char name[64];
-        LogicalDevice* ld;
-    } ld_cache[64];
+    StrIndex ld_index;        // LD name -> position in lds
+    LogicalDevice** lds;
     size_t ld_count;
+    size_t ld_capacity;
+    StrIndex ln_index;        // (LD name, LN name) -> position in lns
+    LogicalNode** lns;
+    size_t ln_count;
+    size_t ln_capacity;
+    StrIndex attr_index;      // leaf reference ("LD0/MMXU1.Amp.mag.f") -> attribute id
+    DataAttribute** attrs;    // attribute id -> leaf DataAttribute, ids are dense and in model order
+    size_t attr_count;
+    size_t attr_capacity;
+    int build_threads;        // > 1 builds the LD subtrees on that many threads
+    char local_ip[48];        // address the server binds to, "" = all interfaces
+    int server_threads;       // > 0 runs the SDK's threaded server for up to that many connections
+    uint64_t cpu_mask;        // CPUs 0-63 the server's threads may run on, 0 = not pinned
+    int rt_priority;          // SCHED_FIFO priority of the server's threads, 0 = normal scheduling
+    atomic_bool stop;         // set to make the server's loop return
+    struct ReportScheduler* reports;  // report deadlines of the threadless loop, NULL otherwise
+    struct DaPlanCache* da_plans;  // per-DOType DA plans, only set inside build_model_from_icd
 } ServerCtx;
 
-int build_model_from_icd(ServerCtx* ctx);
+/* iedName selects one IED of a multi-IED document, NULL = the default one */
+int build_model_from_icd(ServerCtx* ctx, const IcdDocument* icd, const char* iedName);
+/* Blocks while the server runs: threadless loop, or the SDK's threads when server_threads > 0 */
 int start_server(ServerCtx* ctx, int tcp_port);
+/* Serves every ctxs[i] on tcp_ports[i] (and its local_ip) from one process; blocks like start_server */
+int start_servers(ServerCtx* ctxs, const int* tcp_ports, size_t count);
+void release_server_ctx(ServerCtx* ctx); // destroys the server and model and frees the lookup tables
 void dump_model(IedModel* model); // optional debug helper
+
+/*
+ * Attribute handles: every leaf DataAttribute gets an id. Resolve references
+ * once when configuring a feeder and update through the id afterwards.
+ * build_model_from_icd indexes its model; call index_model_attributes for a
+ * model created any other way.
+ */
+#define ATTR_ID_NONE UINT32_MAX
+
+int index_model_attributes(ServerCtx* ctx);
+uint32_t serverctx_find_attr(const ServerCtx* ctx, const char* ref); // ATTR_ID_NONE if not a leaf
+
+static inline DataAttribute* serverctx_attr(const ServerCtx* ctx, uint32_t id)
+{
+    return id < ctx->attr_count ? ctx->attrs[id] : NULL;
+}
+
+/* ---------- Batched attribute updates ---------- */
+
+typedef enum {
+    ATTR_VALUE_BOOL,
+    ATTR_VALUE_INT32,     // also ENUMERATED
+    ATTR_VALUE_UINT32,
+    ATTR_VALUE_FLOAT,
+    ATTR_VALUE_DBPOS,
+    ATTR_VALUE_MMS        // any other type; the batch does not own the value
+} AttrValueKind;
+
+typedef struct {
+    uint32_t id;              // from serverctx_find_attr
+    AttrValueKind kind;
+    union {
+        bool b;
+        int32_t i;
+        uint32_t u;
+        float f;
+        Dbpos dbpos;
+        MmsValue* mms;
+    } value;
+    bool hasQuality;          // also set the q of the attribute's data object
+    Quality quality;
+    uint64_t timestampMs;     // also set its t (ms since epoch), 0 = leave t alone
+} AttrUpdate;
+
+typedef struct {
+    AttrUpdate* items;
+    size_t count;
+    size_t capacity;
+    uint32_t* applied;        // ids applied by the last serverctx_apply_batch, room for every item
+    size_t appliedCapacity;
+} AttrUpdateBatch;
+
+void attr_batch_init(AttrUpdateBatch* batch);
+void attr_batch_free(AttrUpdateBatch* batch);
+bool attr_batch_add(AttrUpdateBatch* batch, const AttrUpdate* update); // false on OOM
+
+/*
+ * Applies all updates under one IedServer_lockDataModel/unlockDataModel pair,
+ * so report triggers of dataset members that change together are evaluated
+ * once, then empties the batch. Safe to call from any thread while a threaded
+ * server is running. Returns the number of updates applied; unknown
+ * ids are skipped.
+ */
+size_t serverctx_apply_batch(ServerCtx* ctx, AttrUpdateBatch* batch);
@@ -0,0 +1,382 @@
+/*
+ * File: model_static.c
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Writes a built model as a compile-time initialized libiec61850 static model.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "model_static.h"
+#include "str_index.h"
+
+#include "iec61850_model.h"
+
+typedef struct {
+    FILE* fp;
+    StrIndex idents;      // C identifiers in use, position = identifier id
+    StrIndex byObject;    // address of a model object -> identifier id
+} StaticEmitter;
+
+/* ---------- identifiers ---------- */
+
+static const char* object_key(char buf[32], const void* object)
+{
+    snprintf(buf, 32, "%p", object);
+    return buf;
+}
+
+static const char* ident_of(const StaticEmitter* em, const void* object)
+{
+    char key[32];
+    uint32_t pos;
+    if (!object || !str_index_find(&em->byObject, object_key(key, object), &pos))
+        return NULL;
+    return str_index_key_at(&em->idents, pos);
+}
+
+static void append_ident(char* dest, size_t destSize, const char* part)
+{
+    size_t len = strlen(dest);
+    if (len && len < destSize - 1)
+        dest[len++] = '_';
+    for (const char* p = part ? part : ""; *p && len < destSize - 1; ++p)
+        dest[len++] = isalnum((unsigned char)*p) ? *p : '_';
+    dest[len] = '\0';
+}
+
+/* Names the object after its path; a numeric suffix keeps clashing paths apart */
+static bool assign_ident(StaticEmitter* em, const void* object, const char* parentIdent, const char* name)
+{
+    char base[400] = "";
+    append_ident(base, sizeof(base), parentIdent);
+    append_ident(base, sizeof(base), name);
+
+    char ident[420];
+    snprintf(ident, sizeof(ident), "%s", base);
+    for (unsigned n = 2; str_index_find(&em->idents, ident, NULL); ++n)
+        snprintf(ident, sizeof(ident), "%s_%u", base, n);
+
+    char key[32];
+    uint32_t pos = str_index_intern(&em->idents, ident);
+    return pos != UINT32_MAX && str_index_insert(&em->byObject, object_key(key, object), pos);
+}
+
+static bool collect_node(StaticEmitter* em, ModelNode* node, const char* parentIdent)
+{
+    if (!assign_ident(em, node, parentIdent, node->name))
+        return false;
+    char ident[420];
+    snprintf(ident, sizeof(ident), "%s", ident_of(em, node));
+    for (ModelNode* child = node->firstChild; child; child = child->sibling) {
+        if (!collect_node(em, child, ident))
+            return false;
+    }
+    return true;
+}
+
+static bool collect_model(StaticEmitter* em, IedModel* model)
+{
+    for (LogicalDevice* ld = model->firstChild; ld; ld = (LogicalDevice*)ld->sibling) {
+        if (!collect_node(em, (ModelNode*)ld, "iedModel"))
+            return false;
+    }
+    for (DataSet* ds = model->dataSets; ds; ds = ds->sibling) {
+        char dsIdent[420] = "iedModelds";
+        append_ident(dsIdent, sizeof(dsIdent), ds->logicalDeviceName);
+        if (!assign_ident(em, ds, dsIdent, ds->name))
+            return false;
+        snprintf(dsIdent, sizeof(dsIdent), "%s", ident_of(em, ds));
+        int n = 0;
+        for (DataSetEntry* e = ds->fcdas; e; e = e->sibling) {
+            char entryName[16];
+            snprintf(entryName, sizeof(entryName), "fcda%d", n++);
+            if (!assign_ident(em, e, dsIdent, entryName))
+                return false;
+        }
+    }
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling) {
+        const char* lnIdent = ident_of(em, rcb->parent);
+        if (!assign_ident(em, rcb, lnIdent ? lnIdent : "iedModel", rcb->name))
+            return false;
+    }
+    return true;
+}
+
+/* ---------- emitting ---------- */
+
+static void emit_string(FILE* fp, const char* s)
+{
+    if (!s) {
+        fputs("NULL", fp);
+        return;
+    }
+    fputc('"', fp);
+    for (const unsigned char* p = (const unsigned char*)s; *p; ++p) {
+        if (*p == '"' || *p == '\\')
+            fprintf(fp, "\\%c", *p);
+        else if (isprint(*p))
+            fputc(*p, fp);
+        else
+            fprintf(fp, "\\%03o", *p);
+    }
+    fputc('"', fp);
+}
+
+static void emit_ref(const StaticEmitter* em, const char* cast, const void* object)
+{
+    const char* ident = ident_of(em, object);
+    if (ident)
+        fprintf(em->fp, "(%s) &%s", cast, ident);
+    else
+        fputs("NULL", em->fp);
+}
+
+static const char* fc_name(FunctionalConstraint fc)
+{
+    switch (fc) {
+    case IEC61850_FC_ST: return "IEC61850_FC_ST";
+    case IEC61850_FC_MX: return "IEC61850_FC_MX";
+    case IEC61850_FC_SP: return "IEC61850_FC_SP";
+    case IEC61850_FC_SV: return "IEC61850_FC_SV";
+    case IEC61850_FC_CF: return "IEC61850_FC_CF";
+    case IEC61850_FC_DC: return "IEC61850_FC_DC";
+    case IEC61850_FC_SG: return "IEC61850_FC_SG";
+    case IEC61850_FC_SE: return "IEC61850_FC_SE";
+    case IEC61850_FC_SR: return "IEC61850_FC_SR";
+    case IEC61850_FC_OR: return "IEC61850_FC_OR";
+    case IEC61850_FC_BL: return "IEC61850_FC_BL";
+    case IEC61850_FC_EX: return "IEC61850_FC_EX";
+    case IEC61850_FC_CO: return "IEC61850_FC_CO";
+    case IEC61850_FC_US: return "IEC61850_FC_US";
+    case IEC61850_FC_MS: return "IEC61850_FC_MS";
+    case IEC61850_FC_RP: return "IEC61850_FC_RP";
+    case IEC61850_FC_BR: return "IEC61850_FC_BR";
+    case IEC61850_FC_LG: return "IEC61850_FC_LG";
+    case IEC61850_FC_GO: return "IEC61850_FC_GO";
+    case IEC61850_FC_ALL: return "IEC61850_FC_ALL";
+    default: return "IEC61850_FC_NONE";
+    }
+}
+
+static const char* type_name(DataAttributeType type)
+{
+    switch (type) {
+    case IEC61850_BOOLEAN: return "IEC61850_BOOLEAN";
+    case IEC61850_INT8: return "IEC61850_INT8";
+    case IEC61850_INT16: return "IEC61850_INT16";
+    case IEC61850_INT32: return "IEC61850_INT32";
+    case IEC61850_INT64: return "IEC61850_INT64";
+    case IEC61850_INT128: return "IEC61850_INT128";
+    case IEC61850_INT8U: return "IEC61850_INT8U";
+    case IEC61850_INT16U: return "IEC61850_INT16U";
+    case IEC61850_INT24U: return "IEC61850_INT24U";
+    case IEC61850_INT32U: return "IEC61850_INT32U";
+    case IEC61850_FLOAT32: return "IEC61850_FLOAT32";
+    case IEC61850_FLOAT64: return "IEC61850_FLOAT64";
+    case IEC61850_ENUMERATED: return "IEC61850_ENUMERATED";
+    case IEC61850_OCTET_STRING_64: return "IEC61850_OCTET_STRING_64";
+    case IEC61850_OCTET_STRING_6: return "IEC61850_OCTET_STRING_6";
+    case IEC61850_OCTET_STRING_8: return "IEC61850_OCTET_STRING_8";
+    case IEC61850_VISIBLE_STRING_32: return "IEC61850_VISIBLE_STRING_32";
+    case IEC61850_VISIBLE_STRING_64: return "IEC61850_VISIBLE_STRING_64";
+    case IEC61850_VISIBLE_STRING_65: return "IEC61850_VISIBLE_STRING_65";
+    case IEC61850_VISIBLE_STRING_129: return "IEC61850_VISIBLE_STRING_129";
+    case IEC61850_VISIBLE_STRING_255: return "IEC61850_VISIBLE_STRING_255";
+    case IEC61850_UNICODE_STRING_255: return "IEC61850_UNICODE_STRING_255";
+    case IEC61850_TIMESTAMP: return "IEC61850_TIMESTAMP";
+    case IEC61850_QUALITY: return "IEC61850_QUALITY";
+    case IEC61850_CHECK: return "IEC61850_CHECK";
+    case IEC61850_CODEDENUM: return "IEC61850_CODEDENUM";
+    case IEC61850_GENERIC_BITSTRING: return "IEC61850_GENERIC_BITSTRING";
+    case IEC61850_CONSTRUCTED: return "IEC61850_CONSTRUCTED";
+    case IEC61850_ENTRY_TIME: return "IEC61850_ENTRY_TIME";
+    case IEC61850_PHYCOMADDR: return "IEC61850_PHYCOMADDR";
+    case IEC61850_CURRENCY: return "IEC61850_CURRENCY";
+    case IEC61850_OPTFLDS: return "IEC61850_OPTFLDS";
+    case IEC61850_TRGOPS: return "IEC61850_TRGOPS";
+    default: return "IEC61850_UNKNOWN_TYPE";
+    }
+}
+
+static const char* node_struct(ModelNodeType type)
+{
+    switch (type) {
+    case LogicalDeviceModelType: return "LogicalDevice";
+    case LogicalNodeModelType: return "LogicalNode";
+    case DataObjectModelType: return "DataObject";
+    default: return "DataAttribute";
+    }
+}
+
+static const char* node_type_name(ModelNodeType type)
+{
+    switch (type) {
+    case LogicalDeviceModelType: return "LogicalDeviceModelType";
+    case LogicalNodeModelType: return "LogicalNodeModelType";
+    case DataObjectModelType: return "DataObjectModelType";
+    default: return "DataAttributeModelType";
+    }
+}
+
+static void declare_node(const StaticEmitter* em, ModelNode* node)
+{
+    fprintf(em->fp, "static %s %s;\n", node_struct(node->modelType), ident_of(em, node));
+    for (ModelNode* child = node->firstChild; child; child = child->sibling)
+        declare_node(em, child);
+}
+
+static void define_node(const StaticEmitter* em, ModelNode* node)
+{
+    FILE* fp = em->fp;
+    fprintf(fp, "static %s %s = {\n    .modelType = %s,\n    .name = ", node_struct(node->modelType),
+            ident_of(em, node), node_type_name(node->modelType));
+    emit_string(fp, node->name);
+    fputs(",\n    .parent = ", fp);
+    if (node->modelType == LogicalDeviceModelType)
+        fputs("(ModelNode*) &iedModel", fp);
+    else
+        emit_ref(em, "ModelNode*", node->parent);
+    fputs(",\n    .sibling = ", fp);
+    emit_ref(em, "ModelNode*", node->sibling);
+    fputs(",\n    .firstChild = ", fp);
+    emit_ref(em, "ModelNode*", node->firstChild);
+
+    if (node->modelType == DataObjectModelType) {
+        DataObject* dobj = (DataObject*)node;
+        fprintf(fp, ",\n    .elementCount = %d,\n    .arrayIndex = %d", dobj->elementCount, dobj->arrayIndex);
+    }
+    else if (node->modelType == DataAttributeModelType) {
+        DataAttribute* da = (DataAttribute*)node;
+        fprintf(fp, ",\n    .elementCount = %d,\n    .arrayIndex = %d,\n    .fc = %s,\n    .type = %s,\n"
+                    "    .triggerOptions = %u,\n    .mmsValue = NULL,\n    .sAddr = %u",
+                da->elementCount, da->arrayIndex, fc_name(da->fc), type_name(da->type),
+                (unsigned)da->triggerOptions, (unsigned)da->sAddr);
+    }
+    fputs("\n};\n\n", fp);
+
+    for (ModelNode* child = node->firstChild; child; child = child->sibling)
+        define_node(em, child);
+}
+
+static void emit_datasets(const StaticEmitter* em, IedModel* model)
+{
+    FILE* fp = em->fp;
+    for (DataSet* ds = model->dataSets; ds; ds = ds->sibling) {
+        for (DataSetEntry* e = ds->fcdas; e; e = e->sibling) {
+            fprintf(fp, "static DataSetEntry %s = {\n    .logicalDeviceName = ", ident_of(em, e));
+            emit_string(fp, e->logicalDeviceName);
+            fputs(",\n    .isLDNameDynamicallyAllocated = false,\n    .variableName = ", fp);
+            emit_string(fp, e->variableName);
+            fprintf(fp, ",\n    .index = %d,\n    .componentName = ", e->index);
+            emit_string(fp, e->componentName);
+            fputs(",\n    .value = NULL,\n    .sibling = ", fp);
+            emit_ref(em, "DataSetEntry*", e->sibling);
+            fputs("\n};\n\n", fp);
+        }
+
+        fprintf(fp, "static DataSet %s = {\n    .logicalDeviceName = ", ident_of(em, ds));
+        emit_string(fp, ds->logicalDeviceName);
+        fputs(",\n    .name = ", fp);
+        emit_string(fp, ds->name);
+        fprintf(fp, ",\n    .elementCount = %d,\n    .fcdas = ", ds->elementCount);
+        emit_ref(em, "DataSetEntry*", ds->fcdas);
+        fputs(",\n    .sibling = ", fp);
+        emit_ref(em, "DataSet*", ds->sibling);
+        fputs("\n};\n\n", fp);
+    }
+}
+
+static void emit_reports(const StaticEmitter* em, IedModel* model)
+{
+    FILE* fp = em->fp;
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling) {
+        fprintf(fp, "static ReportControlBlock %s = {\n    .parent = ", ident_of(em, rcb));
+        emit_ref(em, "LogicalNode*", rcb->parent);
+        fputs(",\n    .name = ", fp);
+        emit_string(fp, rcb->name);
+        fputs(",\n    .rptId = ", fp);
+        emit_string(fp, rcb->rptId);
+        fprintf(fp, ",\n    .buffered = %s,\n    .dataSetName = ", rcb->buffered ? "true" : "false");
+        emit_string(fp, rcb->dataSetName);
+        fprintf(fp, ",\n    .confRef = %u,\n    .trgOps = %u,\n    .options = %u,\n    .bufferTime = %u,\n"
+                    "    .intPeriod = %u,\n    .sibling = ",
+                (unsigned)rcb->confRef, (unsigned)rcb->trgOps, (unsigned)rcb->options,
+                (unsigned)rcb->bufferTime, (unsigned)rcb->intPeriod);
+        emit_ref(em, "ReportControlBlock*", rcb->sibling);
+        fputs("\n};\n\n", fp);
+    }
+}
+
+static void emit_model(const StaticEmitter* em, IedModel* model, const char* iedName)
+{
+    FILE* fp = em->fp;
+    fputs("/*\n * Static IEC 61850 model generated by iec61850_csv_server --emit-static-model", fp);
+    fprintf(fp, "\n * IED: %s\n * Do not edit; regenerate it from the ICD instead.\n */\n\n", iedName);
+    fputs("#include <stdbool.h>\n#include <stddef.h>\n\n#include \"iec61850_model.h\"\n\n", fp);
+
+    fputs("IedModel iedModel;\n", fp);
+    for (LogicalDevice* ld = model->firstChild; ld; ld = (LogicalDevice*)ld->sibling)
+        declare_node(em, (ModelNode*)ld);
+    for (DataSet* ds = model->dataSets; ds; ds = ds->sibling) {
+        fprintf(fp, "static DataSet %s;\n", ident_of(em, ds));
+        for (DataSetEntry* e = ds->fcdas; e; e = e->sibling)
+            fprintf(fp, "static DataSetEntry %s;\n", ident_of(em, e));
+    }
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling)
+        fprintf(fp, "static ReportControlBlock %s;\n", ident_of(em, rcb));
+    fputs("\n", fp);
+
+    for (LogicalDevice* ld = model->firstChild; ld; ld = (LogicalDevice*)ld->sibling)
+        define_node(em, (ModelNode*)ld);
+    emit_datasets(em, model);
+    emit_reports(em, model);
+
+    fputs("static void initializeValues(void)\n{\n}\n\n", fp);
+    fputs("IedModel iedModel = {\n    .name = ", fp);
+    emit_string(fp, model->name);
+    fputs(",\n    .firstChild = ", fp);
+    emit_ref(em, "LogicalDevice*", model->firstChild);
+    fputs(",\n    .dataSets = ", fp);
+    emit_ref(em, "DataSet*", model->dataSets);
+    fputs(",\n    .rcbs = ", fp);
+    emit_ref(em, "ReportControlBlock*", model->rcbs);
+    fputs(",\n    .initializer = initializeValues\n};\n", fp);
+}
+
+int emit_static_model(const ServerCtx* ctx, const char* path)
+{
+    if (!ctx || !ctx->model || !path)
+        return -1;
+
+    StaticEmitter em = {0};
+    str_index_init(&em.idents, 1024);
+    str_index_init(&em.byObject, 1024);
+    if (!collect_model(&em, ctx->model)) {
+        fprintf(stderr, "❌ OOM while naming static model objects\n");
+        str_index_free(&em.idents);
+        str_index_free(&em.byObject);
+        return -1;
+    }
+
+    em.fp = fopen(path, "w");
+    if (!em.fp) {
+        fprintf(stderr, "❌ Cannot write static model %s\n", path);
+        str_index_free(&em.idents);
+        str_index_free(&em.byObject);
+        return -1;
+    }
+    emit_model(&em, ctx->model, ctx->ied_name);
+    int rc = ferror(em.fp) ? -1 : 0;
+    if (fclose(em.fp) != 0)
+        rc = -1;
+    if (rc != 0)
+        fprintf(stderr, "❌ Failed writing static model %s\n", path);
+
+    str_index_free(&em.idents);
+    str_index_free(&em.byObject);
+    return rc;
+}
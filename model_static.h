@@ -0,0 +1,17 @@
+#pragma once
+
+/*
+ * File: model_static.h
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Writes a built model as a compile-time initialized libiec61850 static model.
+ */
+
+#include "model_iec.h"
+
+/*
+ * Writes ctx->model (after build_model_from_icd) as C source that defines
+ * `IedModel iedModel`. Build it together with main.c and model_iec.c using
+ * -DSTATIC_MODEL to get a server without the ICD parser. Returns 0 on success.
+ */
+int emit_static_model(const ServerCtx* ctx, const char* path);
@@ -0,0 +1,378 @@
+/*
+ * File: report_sched.c
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Deadline heap for report integrity, buffer-time and GI timers of the threadless server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "report_sched.h"
+
+#include "iec61850_model.h"
+#include "hal_time.h"
+
+#define SCHED_NOT_QUEUED UINT32_MAX
+// Wake this long after a mirrored deadline so the SDK's own check has surely passed
+#define REPORT_SCHED_SLACK_MS 1
+
+/*
+ * The SDK keeps the real report timers; each RcbTimer mirrors them from the
+ * RCB events so the loop knows when performPeriodicTasks has work to do.
+ */
+typedef struct {
+    ReportControlBlock* rcb;
+    bool enabled;
+    uint32_t intgPd;          // 0 = no integrity reports
+    uint32_t bufTm;
+    uint64_t nextIntegrity;   // SDK's next integrity report time, 0 = not armed
+    uint64_t nextBuffer;      // end of the running buffer time, 0 = nothing buffered
+    bool giPending;
+    bool watchAll;            // dataset replaced by a client: any change may report
+    uint64_t due;             // heap key
+    uint32_t heapPos;         // SCHED_NOT_QUEUED when no deadline is pending
+} RcbTimer;
+
+// One (attribute, RCB) pair of the dataset map
+typedef struct {
+    uint32_t timer;
+    uint32_t next;            // next watch of the same attribute, SCHED_NOT_QUEUED = last
+} RcbWatch;
+
+struct ReportScheduler {
+    IedServer server;         // set by report_sched_attach
+    pthread_mutex_t lock;     // events arrive on the loop thread, data changes from feeders
+    RcbTimer* timers;         // sorted by RCB address
+    size_t count;
+    uint32_t* heap;           // timer positions, earliest due first
+    size_t heapCount;
+    uint32_t minBufTm;        // smallest bufTm of the enabled RCBs, 0 = none has one
+    uint32_t* attrFirst;      // per attribute id, first watch, SCHED_NOT_QUEUED = in no dataset
+    size_t attrCount;
+    RcbWatch* watches;
+    size_t watchCount;
+    size_t watchCapacity;
+    size_t watchAllCount;     // timers with watchAll set
+};
+
+/* ---------- heap ---------- */
+
+static void heap_place(ReportScheduler* sched, size_t pos, uint32_t timer)
+{
+    sched->heap[pos] = timer;
+    sched->timers[timer].heapPos = (uint32_t)pos;
+}
+
+static void heap_sift_up(ReportScheduler* sched, size_t pos)
+{
+    uint32_t timer = sched->heap[pos];
+    uint64_t due = sched->timers[timer].due;
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (sched->timers[sched->heap[parent]].due <= due)
+            break;
+        heap_place(sched, pos, sched->heap[parent]);
+        pos = parent;
+    }
+    heap_place(sched, pos, timer);
+}
+
+static void heap_sift_down(ReportScheduler* sched, size_t pos)
+{
+    uint32_t timer = sched->heap[pos];
+    uint64_t due = sched->timers[timer].due;
+    for (;;) {
+        size_t child = pos * 2 + 1;
+        if (child >= sched->heapCount)
+            break;
+        if (child + 1 < sched->heapCount &&
+            sched->timers[sched->heap[child + 1]].due < sched->timers[sched->heap[child]].due)
+            child++;
+        if (sched->timers[sched->heap[child]].due >= due)
+            break;
+        heap_place(sched, pos, sched->heap[child]);
+        pos = child;
+    }
+    heap_place(sched, pos, timer);
+}
+
+static void heap_remove(ReportScheduler* sched, RcbTimer* t)
+{
+    size_t pos = t->heapPos;
+    t->heapPos = SCHED_NOT_QUEUED;
+    if (--sched->heapCount == pos)
+        return;
+    // The last entry takes the hole and moves whichever way its key requires
+    uint32_t moved = sched->heap[sched->heapCount];
+    heap_place(sched, pos, moved);
+    heap_sift_up(sched, pos);
+    heap_sift_down(sched, sched->timers[moved].heapPos);
+}
+
+static uint64_t timer_due(const RcbTimer* t)
+{
+    if (!t->enabled)
+        return REPORT_SCHED_NONE;
+    if (t->giPending)
+        return 0;
+    uint64_t due = REPORT_SCHED_NONE;
+    if (t->nextIntegrity)
+        due = t->nextIntegrity + REPORT_SCHED_SLACK_MS;
+    if (t->nextBuffer && t->nextBuffer + REPORT_SCHED_SLACK_MS < due)
+        due = t->nextBuffer + REPORT_SCHED_SLACK_MS;
+    return due;
+}
+
+// Re-queues t after its deadlines changed
+static void timer_update(ReportScheduler* sched, RcbTimer* t)
+{
+    uint64_t due = timer_due(t);
+    if (due == REPORT_SCHED_NONE) {
+        if (t->heapPos != SCHED_NOT_QUEUED)
+            heap_remove(sched, t);
+        return;
+    }
+    t->due = due;
+    if (t->heapPos == SCHED_NOT_QUEUED) {
+        heap_place(sched, sched->heapCount++, (uint32_t)(t - sched->timers));
+        heap_sift_up(sched, sched->heapCount - 1);
+    }
+    else {
+        heap_sift_up(sched, t->heapPos);
+        heap_sift_down(sched, t->heapPos);
+    }
+}
+
+/* ---------- RCB state ---------- */
+
+static int compare_timer_rcb(const void* a, const void* b)
+{
+    uintptr_t x = (uintptr_t)((const RcbTimer*)a)->rcb, y = (uintptr_t)((const RcbTimer*)b)->rcb;
+    return x < y ? -1 : x > y;
+}
+
+static RcbTimer* find_timer(ReportScheduler* sched, ReportControlBlock* rcb)
+{
+    RcbTimer key = { .rcb = rcb };
+    return bsearch(&key, sched->timers, sched->count, sizeof(RcbTimer), compare_timer_rcb);
+}
+
+static void timer_sync_config(RcbTimer* t)
+{
+    int trgOps = ReportControlBlock_getTrgOps(t->rcb);
+    t->enabled = ReportControlBlock_getRptEna(t->rcb);
+    t->intgPd = (trgOps & TRG_OPT_INTEGRITY) ? ReportControlBlock_getIntgPd(t->rcb) : 0;
+    t->bufTm = ReportControlBlock_getBufTm(t->rcb);
+}
+
+// bufTm 0 reports right away; a running buffer time is not extended
+static void start_buffer_time(ReportScheduler* sched, RcbTimer* t, uint64_t now)
+{
+    if (!t->enabled || t->bufTm == 0 || t->nextBuffer)
+        return;
+    t->nextBuffer = now + t->bufTm;
+    timer_update(sched, t);
+}
+
+static void update_min_buf_tm(ReportScheduler* sched)
+{
+    uint32_t minBufTm = 0;
+    for (size_t i = 0; i < sched->count; ++i) {
+        const RcbTimer* t = &sched->timers[i];
+        if (t->enabled && t->bufTm && (minBufTm == 0 || t->bufTm < minBufTm))
+            minBufTm = t->bufTm;
+    }
+    sched->minBufTm = minBufTm;
+}
+
+static void rcb_event_handler(void* parameter, ReportControlBlock* rcb, ClientConnection connection,
+                              IedServer_RCBEventType event, const char* parameterName,
+                              MmsDataAccessError serviceError)
+{
+    (void)connection;
+    ReportScheduler* sched = parameter;
+    if (serviceError != DATA_ACCESS_ERROR_SUCCESS)
+        return;
+
+    pthread_mutex_lock(&sched->lock);
+    RcbTimer* t = find_timer(sched, rcb);
+    if (!t) {
+        pthread_mutex_unlock(&sched->lock);
+        return;
+    }
+    uint64_t now = Hal_getTimeInMs();
+    uint32_t oldIntgPd = t->intgPd;
+
+    switch (event) {
+    case RCB_EVENT_ENABLE:
+        timer_sync_config(t);
+        t->nextIntegrity = t->intgPd ? now + t->intgPd : 0;
+        t->nextBuffer = 0;
+        t->giPending = false;
+        break;
+    case RCB_EVENT_DISABLE:
+        t->enabled = false;
+        t->nextIntegrity = t->nextBuffer = 0;
+        t->giPending = false;
+        break;
+    case RCB_EVENT_SET_PARAMETER:
+        // The attribute map only knows the configured datasets
+        if (parameterName && strcmp(parameterName, "DatSet") == 0 && !t->watchAll) {
+            t->watchAll = true;
+            sched->watchAllCount++;
+        }
+        timer_sync_config(t);
+        if (t->intgPd != oldIntgPd)
+            t->nextIntegrity = t->enabled && t->intgPd ? now + t->intgPd : 0;
+        break;
+    case RCB_EVENT_GI:
+        t->giPending = true;
+        break;
+    default:
+        pthread_mutex_unlock(&sched->lock);
+        return;
+    }
+    if (event != RCB_EVENT_GI)
+        update_min_buf_tm(sched);
+    timer_update(sched, t);
+    pthread_mutex_unlock(&sched->lock);
+}
+
+/* ---------- public API ---------- */
+
+ReportScheduler* report_sched_create(IedModel* model, size_t attrCount)
+{
+    ReportScheduler* sched = calloc(1, sizeof(ReportScheduler));
+    if (!sched)
+        return NULL;
+    pthread_mutex_init(&sched->lock, NULL);
+
+    // The SDK reuses rcb->sibling once the server exists, so the list is only walked here
+    size_t count = 0;
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling)
+        count++;
+    sched->timers = calloc(count + 1, sizeof(RcbTimer));
+    sched->heap = calloc(count + 1, sizeof(uint32_t));
+    sched->attrFirst = malloc((attrCount + 1) * sizeof(uint32_t));
+    if (!sched->timers || !sched->heap || !sched->attrFirst) {
+        report_sched_destroy(sched);
+        return NULL;
+    }
+    for (ReportControlBlock* rcb = model->rcbs; rcb; rcb = rcb->sibling)
+        sched->timers[sched->count++].rcb = rcb;
+    qsort(sched->timers, sched->count, sizeof(RcbTimer), compare_timer_rcb);
+    for (size_t i = 0; i < sched->count; ++i)
+        sched->timers[i].heapPos = SCHED_NOT_QUEUED;
+    sched->attrCount = attrCount;
+    for (size_t i = 0; i < attrCount; ++i)
+        sched->attrFirst[i] = SCHED_NOT_QUEUED;
+    return sched;
+}
+
+bool report_sched_watch(ReportScheduler* sched, ReportControlBlock* rcb, uint32_t attrId)
+{
+    RcbTimer* t = find_timer(sched, rcb);
+    if (!t || attrId >= sched->attrCount)
+        return false;
+    uint32_t timer = (uint32_t)(t - sched->timers);
+    uint32_t head = sched->attrFirst[attrId];
+    if (head != SCHED_NOT_QUEUED && sched->watches[head].timer == timer)
+        return true; // overlapping dataset members
+    if (sched->watchCount == sched->watchCapacity) {
+        size_t newCap = sched->watchCapacity ? sched->watchCapacity * 2 : 256;
+        RcbWatch* watches = realloc(sched->watches, newCap * sizeof(RcbWatch));
+        if (!watches)
+            return false;
+        sched->watches = watches;
+        sched->watchCapacity = newCap;
+    }
+    sched->watches[sched->watchCount] = (RcbWatch){ .timer = timer, .next = head };
+    sched->attrFirst[attrId] = (uint32_t)sched->watchCount++;
+    return true;
+}
+
+void report_sched_attach(ReportScheduler* sched, IedServer server)
+{
+    sched->server = server;
+    IedServer_setRCBEventHandler(server, rcb_event_handler, sched);
+}
+
+void report_sched_destroy(ReportScheduler* sched)
+{
+    if (!sched)
+        return;
+    if (sched->server)
+        IedServer_setRCBEventHandler(sched->server, NULL, NULL);
+    free(sched->timers);
+    free(sched->heap);
+    free(sched->attrFirst);
+    free(sched->watches);
+    pthread_mutex_destroy(&sched->lock);
+    free(sched);
+}
+
+uint64_t report_sched_next_deadline(ReportScheduler* sched)
+{
+    if (!sched)
+        return REPORT_SCHED_NONE;
+    pthread_mutex_lock(&sched->lock);
+    uint64_t due = sched->heapCount ? sched->timers[sched->heap[0]].due : REPORT_SCHED_NONE;
+    pthread_mutex_unlock(&sched->lock);
+    return due;
+}
+
+uint32_t report_sched_idle_tick(ReportScheduler* sched, uint32_t maxMs)
+{
+    if (!sched)
+        return maxMs;
+    pthread_mutex_lock(&sched->lock);
+    uint32_t tick = sched->minBufTm && sched->minBufTm < maxMs ? sched->minBufTm : maxMs;
+    pthread_mutex_unlock(&sched->lock);
+    return tick;
+}
+
+bool report_sched_run_due(ReportScheduler* sched, uint64_t now)
+{
+    if (!sched || !sched->server || report_sched_next_deadline(sched) > now)
+        return false;
+
+    // Not under our lock: the SDK may raise RCB events from here
+    IedServer_performPeriodicTasks(sched->server);
+
+    pthread_mutex_lock(&sched->lock);
+    while (sched->heapCount && sched->timers[sched->heap[0]].due <= now) {
+        RcbTimer* t = &sched->timers[sched->heap[0]];
+        t->giPending = false;
+        if (t->nextBuffer && t->nextBuffer + REPORT_SCHED_SLACK_MS <= now)
+            t->nextBuffer = 0;
+        if (t->nextIntegrity && t->nextIntegrity + REPORT_SCHED_SLACK_MS <= now) {
+            // Same rule as the SDK: stay on the period grid unless the clock jumped
+            uint64_t next = t->nextIntegrity + t->intgPd;
+            t->nextIntegrity = (next < now || next > now + t->intgPd) ? now + t->intgPd : next;
+        }
+        timer_update(sched, t);
+    }
+    pthread_mutex_unlock(&sched->lock);
+    return true;
+}
+
+void report_sched_data_changed(ReportScheduler* sched, const uint32_t* attrIds, size_t count, uint64_t now)
+{
+    if (!sched || count == 0)
+        return;
+    pthread_mutex_lock(&sched->lock);
+    for (size_t i = 0; i < count; ++i) {
+        if (attrIds[i] >= sched->attrCount)
+            continue;
+        for (uint32_t w = sched->attrFirst[attrIds[i]]; w != SCHED_NOT_QUEUED; w = sched->watches[w].next)
+            start_buffer_time(sched, &sched->timers[sched->watches[w].timer], now);
+    }
+    for (size_t i = 0; sched->watchAllCount && i < sched->count; ++i) {
+        if (sched->timers[i].watchAll)
+            start_buffer_time(sched, &sched->timers[i], now);
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ * File: report_sched.h
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Deadline heap for report integrity, buffer-time and GI timers of the threadless server.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec61850_server.h"
+
+#define REPORT_SCHED_NONE UINT64_MAX
+
+typedef struct ReportScheduler ReportScheduler;
+
+/*
+ * Tracks every RCB of model; call before the server is created from it.
+ * attrCount is the number of attribute ids report_sched_watch may map. NULL on OOM.
+ */
+ReportScheduler* report_sched_create(IedModel* model, size_t attrCount);
+/* A change of attribute attrId may start rcb's buffer time (it is in rcb's dataset). Before attaching. */
+bool report_sched_watch(ReportScheduler* sched, ReportControlBlock* rcb, uint32_t attrId);
+/* Installs sched as the RCB event handler of the server built from its model */
+void report_sched_attach(ReportScheduler* sched, IedServer server);
+void report_sched_destroy(ReportScheduler* sched);
+
+/* Earliest time (Hal_getTimeInMs) at which a report timer is due, REPORT_SCHED_NONE if none */
+uint64_t report_sched_next_deadline(ReportScheduler* sched);
+
+/*
+ * Longest idle tick that still flushes buffer times the scheduler was not told
+ * about (MMS writes, controls) within one bufTm: the smallest enabled bufTm, at most maxMs.
+ */
+uint32_t report_sched_idle_tick(ReportScheduler* sched, uint32_t maxMs);
+
+/* Runs IedServer_performPeriodicTasks once if any timer is due at now and re-arms them. */
+bool report_sched_run_due(ReportScheduler* sched, uint64_t now);
+
+/* Attributes attrIds changed: enabled RCBs watching one of them start their buffer time. Any thread. */
+void report_sched_data_changed(ReportScheduler* sched, const uint32_t* attrIds, size_t count, uint64_t now);
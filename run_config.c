@@ -0,0 +1,287 @@
+/*
+ * File: run_config.c
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Loads the JSON run configuration (jansson) for whole-substation deployments.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <jansson.h>
+
+#include "run_config.h"
+#include "str_index.h"
+
+#define RUN_MAX_CPUS 64
+
+static const char* const TOP_KEYS[] = { "icd", "ap", "cache", "stream", "defaults", "ieds", NULL };
+static const char* const IED_KEYS[] = { "name", "port", "ip", "threads", "build_threads", "mapping", "cpus",
+                                        "priority", NULL };
+
+typedef struct {
+    char dir[256];            // directory of the config file, "" = current
+    char* errbuf;
+    size_t errlen;
+} ConfigReader;
+
+static bool fail(ConfigReader* r, const char* where, const char* key, const char* what)
+{
+    snprintf(r->errbuf, r->errlen, "%s%s%s: %s", where, *where ? "." : "", key, what);
+    return false;
+}
+
+static void warn_unknown_keys(json_t* obj, const char* where, const char* const* known)
+{
+    const char* key;
+    json_t* value;
+    json_object_foreach(obj, key, value) {
+        size_t i = 0;
+        while (known[i] && strcmp(known[i], key) != 0)
+            i++;
+        if (!known[i])
+            fprintf(stderr, "⚠️ Run config: unknown key %s%s%s ignored\n", where, *where ? "." : "", key);
+    }
+}
+
+/* ---------- typed fields; a missing key leaves *out unchanged ---------- */
+
+static bool read_int(ConfigReader* r, const json_t* obj, const char* where, const char* key, int min, int max,
+                     int* out)
+{
+    json_t* v = json_object_get(obj, key);
+    if (!v)
+        return true;
+    if (!json_is_integer(v) || json_integer_value(v) < min || json_integer_value(v) > max) {
+        char what[64];
+        snprintf(what, sizeof(what), "expected an integer %d-%d", min, max);
+        return fail(r, where, key, what);
+    }
+    *out = (int)json_integer_value(v);
+    return true;
+}
+
+static bool read_string(ConfigReader* r, const json_t* obj, const char* where, const char* key, char* out,
+                        size_t size)
+{
+    json_t* v = json_object_get(obj, key);
+    if (!v)
+        return true;
+    if (!json_is_string(v))
+        return fail(r, where, key, "expected a string");
+    if (snprintf(out, size, "%s", json_string_value(v)) >= (int)size)
+        return fail(r, where, key, "too long");
+    return true;
+}
+
+// Relative paths are taken from the directory of the config file
+static bool read_path(ConfigReader* r, const json_t* obj, const char* where, const char* key, char* out,
+                      size_t size)
+{
+    json_t* v = json_object_get(obj, key);
+    if (!v)
+        return true;
+    if (!json_is_string(v))
+        return fail(r, where, key, "expected a string");
+    const char* path = json_string_value(v);
+    int n = (path[0] == '/' || !r->dir[0] || !path[0]) ? snprintf(out, size, "%s", path)
+                                                        : snprintf(out, size, "%s/%s", r->dir, path);
+    if (n < 0 || (size_t)n >= size)
+        return fail(r, where, key, "path too long");
+    return true;
+}
+
+static bool read_bool(ConfigReader* r, const json_t* obj, const char* where, const char* key, bool* out)
+{
+    json_t* v = json_object_get(obj, key);
+    if (!v)
+        return true;
+    if (!json_is_boolean(v))
+        return fail(r, where, key, "expected true or false");
+    *out = json_is_true(v);
+    return true;
+}
+
+static bool read_cpus(ConfigReader* r, const json_t* obj, const char* where, const char* key, uint64_t* out)
+{
+    json_t* v = json_object_get(obj, key);
+    if (!v)
+        return true;
+    if (!json_is_array(v))
+        return fail(r, where, key, "expected an array of CPU numbers");
+    uint64_t mask = 0;
+    size_t i;
+    json_t* cpu;
+    json_array_foreach(v, i, cpu) {
+        if (!json_is_integer(cpu) || json_integer_value(cpu) < 0 || json_integer_value(cpu) >= RUN_MAX_CPUS)
+            return fail(r, where, key, "expected CPU numbers 0-63");
+        mask |= UINT64_C(1) << json_integer_value(cpu);
+    }
+    *out = mask;
+    return true;
+}
+
+/* ---------- IEDs ---------- */
+
+// Settings shared by "defaults" and the "ieds" entries
+static bool read_ied_settings(ConfigReader* r, json_t* obj, const char* where, RunIed* ied)
+{
+    return read_int(r, obj, where, "port", 1, 65535, &ied->tcp_port) &&
+           read_string(r, obj, where, "ip", ied->local_ip, sizeof(ied->local_ip)) &&
+           read_int(r, obj, where, "threads", 0, 4096, &ied->server_threads) &&
+           read_int(r, obj, where, "build_threads", 1, 256, &ied->build_threads) &&
+           read_path(r, obj, where, "mapping", ied->mapping_path, sizeof(ied->mapping_path)) &&
+           read_cpus(r, obj, where, "cpus", &ied->cpu_mask) &&
+           read_int(r, obj, where, "priority", 0, 99, &ied->rt_priority);
+}
+
+typedef struct {
+    StrIndex names;
+    StrIndex endpoints;       // (ip, port) of IEDs bound to one address
+    StrIndex specificPorts;   // ports with an IED bound to one address
+    StrIndex anyPorts;        // ports with an IED bound to all interfaces
+} EndpointCheck;
+
+static void endpoint_check_free(EndpointCheck* c)
+{
+    str_index_free(&c->names);
+    str_index_free(&c->endpoints);
+    str_index_free(&c->specificPorts);
+    str_index_free(&c->anyPorts);
+}
+
+// Two IEDs cannot share a name, nor an address and port
+static bool check_unique(ConfigReader* r, EndpointCheck* c, const RunIed* ied, const char* where)
+{
+    char port[16], key[96];
+    snprintf(port, sizeof(port), "%d", ied->tcp_port);
+    if (!str_index_insert(&c->names, ied->name, 0))
+        return fail(r, where, "name", "IED listed twice");
+    if (str_index_find(&c->anyPorts, port, NULL))
+        return fail(r, where, "port", "already used by an IED on all interfaces");
+    if (!ied->local_ip[0]) {
+        if (str_index_find(&c->specificPorts, port, NULL))
+            return fail(r, where, "port", "already used by an IED on one address");
+        if (!str_index_insert(&c->anyPorts, port, 0))
+            return fail(r, where, "port", "oom");
+        return true;
+    }
+    if (!str_index_insert(&c->endpoints, str_index_key2(key, sizeof(key), ied->local_ip, port), 0))
+        return fail(r, where, "port", "address and port already used");
+    // A second IED on another address may already have added the port
+    if (!str_index_insert(&c->specificPorts, port, 0) && !str_index_find(&c->specificPorts, port, NULL))
+        return fail(r, where, "port", "oom");
+    return true;
+}
+
+static bool read_ieds(ConfigReader* r, json_t* root, RunConfig* cfg)
+{
+    RunIed defaults = { .build_threads = 1 };
+    json_t* defaultsObj = json_object_get(root, "defaults");
+    if (defaultsObj) {
+        if (!json_is_object(defaultsObj))
+            return fail(r, "", "defaults", "expected an object");
+        warn_unknown_keys(defaultsObj, "defaults", IED_KEYS);
+        if (!read_ied_settings(r, defaultsObj, "defaults", &defaults))
+            return false;
+    }
+
+    json_t* list = json_object_get(root, "ieds");
+    if (!json_is_array(list) || json_array_size(list) == 0)
+        return fail(r, "", "ieds", "expected a non-empty array");
+    cfg->ieds = calloc(json_array_size(list), sizeof(RunIed));
+    if (!cfg->ieds)
+        return fail(r, "", "ieds", "oom");
+
+    EndpointCheck check;
+    str_index_init(&check.names, json_array_size(list));
+    str_index_init(&check.endpoints, json_array_size(list));
+    str_index_init(&check.specificPorts, 16);
+    str_index_init(&check.anyPorts, 16);
+
+    size_t i;
+    json_t* entry;
+    bool ok = true;
+    json_array_foreach(list, i, entry) {
+        char where[32];
+        snprintf(where, sizeof(where), "ieds[%zu]", i);
+        RunIed* ied = &cfg->ieds[cfg->ied_count];
+        *ied = defaults;
+        memset(&ied->mapping, 0, sizeof(ied->mapping));
+        cfg->ied_count++;
+        if (!json_is_object(entry)) {
+            ok = fail(r, "", where, "expected an object");
+            break;
+        }
+        warn_unknown_keys(entry, where, IED_KEYS);
+        ok = read_string(r, entry, where, "name", ied->name, sizeof(ied->name)) &&
+             read_ied_settings(r, entry, where, ied);
+        if (ok && ied->tcp_port == 0)
+            ok = fail(r, where, "port", "missing");
+        if (ok)
+            ok = check_unique(r, &check, ied, where);
+        if (ok && ied->mapping_path[0]) {
+            char mapErr[128];
+            if (!load_mapping_csv(ied->mapping_path, &ied->mapping, mapErr, sizeof(mapErr))) {
+                char what[400];
+                snprintf(what, sizeof(what), "%s: %s", ied->mapping_path, mapErr);
+                ok = fail(r, where, "mapping", what);
+            }
+        }
+        if (!ok)
+            break;
+    }
+    endpoint_check_free(&check);
+    return ok;
+}
+
+/* ---------- public API ---------- */
+
+bool load_run_config(const char* path, RunConfig* out, char* errbuf, size_t errlen)
+{
+    memset(out, 0, sizeof(*out));
+    ConfigReader r = { .errbuf = errbuf, .errlen = errlen };
+    const char* slash = strrchr(path, '/');
+    if (slash)
+        snprintf(r.dir, sizeof(r.dir), "%.*s", (int)(slash - path), path);
+    if (slash == path)
+        snprintf(r.dir, sizeof(r.dir), "/");
+
+    json_error_t error;
+    json_t* root = json_load_file(path, 0, &error);
+    if (!root) {
+        snprintf(errbuf, errlen, "line %d column %d: %s", error.line, error.column, error.text);
+        return false;
+    }
+    bool ok = json_is_object(root);
+    if (!ok)
+        snprintf(errbuf, errlen, "expected a JSON object");
+    if (ok) {
+        warn_unknown_keys(root, "", TOP_KEYS);
+        ok = read_path(&r, root, "", "icd", out->icd_path, sizeof(out->icd_path)) &&
+             read_string(&r, root, "", "ap", out->access_point, sizeof(out->access_point)) &&
+             read_path(&r, root, "", "cache", out->cache_path, sizeof(out->cache_path)) &&
+             read_bool(&r, root, "", "stream", &out->stream);
+    }
+    if (ok && !out->icd_path[0])
+        ok = fail(&r, "", "icd", "missing");
+    if (ok)
+        ok = read_ieds(&r, root, out);
+
+    json_decref(root);
+    if (!ok)
+        free_run_config(out);
+    return ok;
+}
+
+void free_run_config(RunConfig* cfg)
+{
+    if (!cfg)
+        return;
+    for (size_t i = 0; i < cfg->ied_count; ++i)
+        free_mapping(&cfg->ieds[i].mapping);
+    free(cfg->ieds);
+    cfg->ieds = NULL;
+    cfg->ied_count = 0;
+}
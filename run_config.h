@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+ * File: run_config.h
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: JSON run configuration listing the IEDs one process serves and how each is tuned.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mapping.h"
+
+typedef struct {
+    char name[64];            // IED name in the SCD, "" = the default one
+    int tcp_port;
+    char local_ip[48];        // address to bind, "" = all interfaces
+    int server_threads;       // > 0 runs the SDK's threaded server, 0 = threadless loop
+    int build_threads;
+    char mapping_path[256];   // Modbus mapping CSV, "" = none
+    MapTable mapping;
+    uint64_t cpu_mask;        // CPUs 0-63 the IED's threads may run on, 0 = not pinned
+    int rt_priority;          // SCHED_FIFO priority 1-99, 0 = normal scheduling
+} RunIed;
+
+typedef struct {
+    char icd_path[256];
+    char access_point[64];    // "" = first AccessPoint of each IED
+    char cache_path[256];     // startup cache, "" = none
+    bool stream;
+    RunIed* ieds;
+    size_t ied_count;
+} RunConfig;
+
+/* Relative paths in the file are taken from the directory of path. Loads the mapping CSVs too. */
+bool load_run_config(const char* path, RunConfig* out, char* errbuf, size_t errlen);
+void free_run_config(RunConfig* cfg);
@@ -0,0 +1,220 @@
+/*
+ * File: str_index.c
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Open-addressing hash index from string keys to 32-bit values.
+ */
+
+#include "str_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t str_hash(const char* key)
+{
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (const unsigned char* p = (const unsigned char*)key; *p; ++p) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool str_index_rehash(StrIndex* idx, size_t slotCount)
+{
+    uint32_t* slots = calloc(slotCount, sizeof(uint32_t));
+    if (!slots)
+        return false;
+
+    size_t mask = slotCount - 1;
+    for (size_t i = 0; i < idx->count; ++i) {
+        size_t pos = idx->entries[i].hash & mask;
+        while (slots[pos])
+            pos = (pos + 1) & mask;
+        slots[pos] = (uint32_t)(i + 1);
+    }
+
+    free(idx->slots);
+    idx->slots = slots;
+    idx->slotCount = slotCount;
+    return true;
+}
+
+void str_index_init(StrIndex* idx, size_t expected)
+{
+    memset(idx, 0, sizeof(*idx));
+    size_t slotCount = 16;
+    while (slotCount < expected * 2)
+        slotCount *= 2;
+    str_index_rehash(idx, slotCount);
+}
+
+void str_index_free(StrIndex* idx)
+{
+    if (!idx)
+        return;
+    free(idx->slots);
+    free(idx->entries);
+    free(idx->keys);
+    memset(idx, 0, sizeof(*idx));
+}
+
+void str_index_clear(StrIndex* idx)
+{
+    if (!idx)
+        return;
+    if (idx->slots)
+        memset(idx->slots, 0, idx->slotCount * sizeof(uint32_t));
+    idx->count = 0;
+    idx->keysUsed = 0;
+}
+
+static const StrIndexEntry* str_index_lookup(const StrIndex* idx, const char* key, uint32_t hash)
+{
+    if (!idx->slots)
+        return NULL;
+    size_t mask = idx->slotCount - 1;
+    for (size_t pos = hash & mask; idx->slots[pos]; pos = (pos + 1) & mask) {
+        const StrIndexEntry* e = &idx->entries[idx->slots[pos] - 1];
+        if (e->hash == hash && strcmp(idx->keys + e->keyOffset, key) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+bool str_index_find(const StrIndex* idx, const char* key, uint32_t* value)
+{
+    if (!idx || !key)
+        return false;
+    const StrIndexEntry* e = str_index_lookup(idx, key, str_hash(key));
+    if (!e)
+        return false;
+    if (value)
+        *value = e->value;
+    return true;
+}
+
+/* Appends a key known to be missing */
+static bool str_index_add(StrIndex* idx, const char* key, uint32_t hash, uint32_t value)
+{
+    if (!idx->slots || (idx->count + 1) * 4 > idx->slotCount * 3) {
+        size_t slotCount = idx->slotCount ? idx->slotCount * 2 : 16;
+        if (!str_index_rehash(idx, slotCount))
+            return false;
+    }
+
+    if (idx->count == idx->capacity) {
+        size_t newCap = idx->capacity ? idx->capacity * 2 : 16;
+        StrIndexEntry* entries = realloc(idx->entries, newCap * sizeof(StrIndexEntry));
+        if (!entries)
+            return false;
+        idx->entries = entries;
+        idx->capacity = newCap;
+    }
+
+    size_t keyLen = strlen(key) + 1;
+    if (idx->keysUsed + keyLen > idx->keysCapacity) {
+        size_t newCap = idx->keysCapacity ? idx->keysCapacity * 2 : 256;
+        while (newCap < idx->keysUsed + keyLen)
+            newCap *= 2;
+        char* keys = realloc(idx->keys, newCap);
+        if (!keys)
+            return false;
+        idx->keys = keys;
+        idx->keysCapacity = newCap;
+    }
+
+    StrIndexEntry* e = &idx->entries[idx->count];
+    e->hash = hash;
+    e->keyOffset = (uint32_t)idx->keysUsed;
+    e->value = value;
+    memcpy(idx->keys + idx->keysUsed, key, keyLen);
+    idx->keysUsed += keyLen;
+
+    size_t mask = idx->slotCount - 1;
+    size_t pos = hash & mask;
+    while (idx->slots[pos])
+        pos = (pos + 1) & mask;
+    idx->slots[pos] = (uint32_t)(++idx->count);
+    return true;
+}
+
+bool str_index_insert(StrIndex* idx, const char* key, uint32_t value)
+{
+    if (!idx || !key)
+        return false;
+
+    uint32_t hash = str_hash(key);
+    if (str_index_lookup(idx, key, hash))
+        return false;
+    return str_index_add(idx, key, hash, value);
+}
+
+uint32_t str_index_intern(StrIndex* idx, const char* key)
+{
+    if (!idx || !key)
+        return UINT32_MAX;
+
+    uint32_t hash = str_hash(key);
+    const StrIndexEntry* e = str_index_lookup(idx, key, hash);
+    if (e)
+        return e->value;
+    uint32_t pos = (uint32_t)idx->count;
+    return str_index_add(idx, key, hash, pos) ? pos : UINT32_MAX;
+}
+
+const char* str_index_key_at(const StrIndex* idx, uint32_t pos)
+{
+    if (!idx || pos >= idx->count)
+        return NULL;
+    return idx->keys + idx->entries[pos].keyOffset;
+}
+
+bool str_index_restore(StrIndex* idx, const uint32_t* slots, size_t slotCount,
+                       const StrIndexEntry* entries, size_t count, const char* keys, size_t keysUsed)
+{
+    if (!idx || slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || count >= slotCount)
+        return false;
+    if (keysUsed > 0 && keys[keysUsed - 1] != '\0')
+        return false;
+    for (size_t i = 0; i < slotCount; ++i)
+        if (slots[i] > count)
+            return false;
+    for (size_t i = 0; i < count; ++i)
+        if (entries[i].keyOffset >= keysUsed)
+            return false;
+
+    memset(idx, 0, sizeof(*idx));
+    idx->slots = malloc(slotCount * sizeof(uint32_t));
+    idx->entries = malloc((count ? count : 1) * sizeof(StrIndexEntry));
+    idx->keys = malloc(keysUsed ? keysUsed : 1);
+    if (!idx->slots || !idx->entries || !idx->keys) {
+        str_index_free(idx);
+        return false;
+    }
+    memcpy(idx->slots, slots, slotCount * sizeof(uint32_t));
+    memcpy(idx->entries, entries, count * sizeof(StrIndexEntry));
+    memcpy(idx->keys, keys, keysUsed);
+    idx->slotCount = slotCount;
+    idx->count = idx->capacity = count;
+    idx->keysUsed = idx->keysCapacity = keysUsed;
+    return true;
+}
+
+const char* str_index_key2(char* buf, size_t size, const char* a, const char* b)
+{
+    snprintf(buf, size, "%s\x1f%s", a ? a : "", b ? b : "");
+    return buf;
+}
+
+const char* str_index_key3(char* buf, size_t size, const char* a, const char* b, const char* c)
+{
+    snprintf(buf, size, "%s\x1f%s\x1f%s", a ? a : "", b ? b : "", c ? c : "");
+    return buf;
+}
+
+const char* str_index_key4(char* buf, size_t size, const char* a, const char* b, const char* c, const char* d)
+{
+    snprintf(buf, size, "%s\x1f%s\x1f%s\x1f%s", a ? a : "", b ? b : "", c ? c : "", d ? d : "");
+    return buf;
+}
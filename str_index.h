@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+ * File: str_index.h
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: Open-addressing hash index from string keys to 32-bit values.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    uint32_t hash;
+    uint32_t keyOffset;   // offset of the key inside StrIndex.keys
+    uint32_t value;
+} StrIndexEntry;
+
+typedef struct {
+    uint32_t* slots;      // 0 = empty, otherwise entry index + 1
+    size_t slotCount;     // always a power of two
+    StrIndexEntry* entries;
+    size_t count;
+    size_t capacity;
+    char* keys;           // all keys, NUL separated, in insertion order
+    size_t keysUsed;
+    size_t keysCapacity;
+} StrIndex;
+
+void str_index_init(StrIndex* idx, size_t expected);
+void str_index_free(StrIndex* idx);
+void str_index_clear(StrIndex* idx);
+
+/* Returns false if the key is missing. */
+bool str_index_find(const StrIndex* idx, const char* key, uint32_t* value);
+/* Returns false if the key already exists or memory is exhausted. */
+bool str_index_insert(StrIndex* idx, const char* key, uint32_t value);
+
+/*
+ * Interning: the value of a key is its insertion position, so keys can be
+ * read back by position. Returns UINT32_MAX when memory is exhausted.
+ */
+uint32_t str_index_intern(StrIndex* idx, const char* key);
+/* NULL if pos is out of range. The pointer is invalidated by the next insert. */
+const char* str_index_key_at(const StrIndex* idx, uint32_t pos);
+
+/* Copy an index from arrays previously taken out of another StrIndex. Returns false if they are inconsistent. */
+bool str_index_restore(StrIndex* idx, const uint32_t* slots, size_t slotCount,
+                       const StrIndexEntry* entries, size_t count, const char* keys, size_t keysUsed);
+
+/* Join two key parts with a separator that cannot appear in SCL names. */
+const char* str_index_key2(char* buf, size_t size, const char* a, const char* b);
+const char* str_index_key3(char* buf, size_t size, const char* a, const char* b, const char* c);
+const char* str_index_key4(char* buf, size_t size, const char* a, const char* b, const char* c, const char* d);
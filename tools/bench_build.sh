@@ -0,0 +1,24 @@
+#!/bin/sh
+# Model build time over several --build-threads values.
+# usage: tools/bench_build.sh SERVER_BINARY FILE.scd [--ied NAME ...] -- [THREADS...]
+# example: tools/gen_scd.py --ieds 1 --lds 64 --lns 200 -o lds.scd
+#          tools/bench_build.sh ./iec61850_csv_server lds.scd -- 1 2 4 8
+set -e
+server=$1
+scd=$2
+shift 2
+args=""
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    args="$args $1"
+    shift
+done
+[ "$1" = "--" ] && shift
+[ $# -gt 0 ] || set -- 1 2 4 8
+
+for threads in "$@"; do
+    # best of three runs
+    for run in 1 2 3; do
+        "$server" "$scd" $args --build-threads "$threads" --build-only
+    done | awk -v t="$threads" '/^Model build:/ { if (best == "" || $3 < best) best = $3 }
+                                END { printf "%2d threads: %8.1f ms\n", t, best }'
+done
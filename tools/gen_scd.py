@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Generate a synthetic multi-IED SCD file for parser benchmarks."""
+import argparse
+import sys
+
+CDCS = {
+    "SPS": [("stVal", "ST", "BOOLEAN", None, "dchg"), ("q", "ST", "Quality", None, "qchg"), ("t", "ST", "Timestamp", None, None)],
+    "DPC": [("stVal", "ST", "Dbpos", None, "dchg"), ("q", "ST", "Quality", None, "qchg"), ("t", "ST", "Timestamp", None, None),
+            ("Oper", "CO", "Struct", "OperDPC", None), ("ctlModel", "CF", "Enum", "ctlModelKind", "dchg")],
+    "MV":  [("mag", "MX", "Struct", "AnalogueValue", "dchg"), ("q", "MX", "Quality", None, "qchg"), ("t", "MX", "Timestamp", None, None),
+            ("units", "CF", "Struct", "Unit", "dchg")],
+    "INS": [("stVal", "ST", "INT32", None, "dchg"), ("q", "ST", "Quality", None, "qchg"), ("t", "ST", "Timestamp", None, None)],
+}
+DATYPES = {
+    "AnalogueValue": [("f", "FLOAT32", None), ("i", "INT32", None)],
+    "Unit": [("SIUnit", "Enum", "SIUnitKind"), ("multiplier", "Enum", "multiplierKind")],
+    "Vector": [("mag", "Struct", "AnalogueValue"), ("ang", "Struct", "AnalogueValue")],
+    "Origin": [("orCat", "Enum", "orCatKind"), ("orIdent", "Octet64", None)],
+    "OperDPC": [("ctlVal", "BOOLEAN", None), ("origin", "Struct", "Origin"), ("ctlNum", "INT8U", None),
+                ("T", "Timestamp", None), ("Test", "BOOLEAN", None), ("Check", "Check", None)],
+}
+LN_CLASSES = [("GGIO", ["SPS", "SPS", "DPC", "INS"]), ("MMXU", ["MV", "MV", "MV", "INS"]), ("XCBR", ["DPC", "SPS", "INS"])]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("--ieds", type=int, default=4)
+    ap.add_argument("--lds", type=int, default=2)
+    ap.add_argument("--lns", type=int, default=10, help="LN instances per LD")
+    ap.add_argument("--types-per-ied", type=int, default=20, help="private DOType copies per IED")
+    ap.add_argument("--templates-first", action="store_true")
+    ap.add_argument("-o", "--output", default="-")
+    args = ap.parse_args()
+
+    out = sys.stdout if args.output == "-" else open(args.output, "w")
+    w = out.write
+    w('<?xml version="1.0" encoding="UTF-8"?>\n<SCL xmlns="http://www.iec.ch/61850/2003/SCL" version="2007">\n')
+    w('  <Header id="synthetic"/>\n')
+
+    def templates():
+        w('  <DataTypeTemplates>\n')
+        for ied in range(args.ieds):
+            for cls, cdcs in LN_CLASSES:
+                w(f'    <LNodeType id="IED{ied}_{cls}" lnClass="{cls}">\n')
+                w('      <DO name="Mod" type="INS_shared"/>\n      <DO name="Beh" type="INS_shared"/>\n')
+                if cls == "MMXU":
+                    w('      <DO name="A" type="WYE_shared"/>\n')
+                for i, cdc in enumerate(cdcs):
+                    tid = f"{cdc}_{ied}_{i % max(1, args.types_per_ied)}"
+                    w(f'      <DO name="{cdc}{i + 1}" type="{tid}"/>\n')
+                w('    </LNodeType>\n')
+            w(f'    <LNodeType id="IED{ied}_LLN0" lnClass="LLN0">\n      <DO name="Mod" type="INS_shared"/>\n'
+              f'      <DO name="Health" type="INS_shared"/>\n    </LNodeType>\n')
+        w('    <DOType id="CMV_shared" cdc="CMV">\n      <DA name="cVal" fc="MX" bType="Struct" type="Vector" dchg="true"/>\n'
+          '      <DA name="q" fc="MX" bType="Quality" qchg="true"/>\n    </DOType>\n')
+        w('    <DOType id="WYE_shared" cdc="WYE">\n      <SDO name="phsA" type="CMV_shared"/>\n'
+          '      <SDO name="phsB" type="CMV_shared"/>\n      <DA name="d" fc="DC" bType="VisString255"/>\n    </DOType>\n')
+        w('    <DOType id="INS_shared" cdc="INS">\n')
+        for n, fc, bt, t, trg in CDCS["INS"]:
+            w(f'      <DA name="{n}" fc="{fc}" bType="{bt}"' + (f' {trg}="true"' if trg else '') + '/>\n')
+        w('    </DOType>\n')
+        for ied in range(args.ieds):
+            for i in range(max(1, args.types_per_ied)):
+                for cdc, das in CDCS.items():
+                    w(f'    <DOType id="{cdc}_{ied}_{i}" cdc="{cdc}">\n')
+                    for n, fc, bt, t, trg in das:
+                        attrs = f'name="{n}" fc="{fc}" bType="{bt}"'
+                        if t:
+                            attrs += f' type="{t}"'
+                        if trg:
+                            attrs += f' {trg}="true"'
+                        w(f'      <DA {attrs}/>\n')
+                    w('    </DOType>\n')
+        for tid, bdas in DATYPES.items():
+            w(f'    <DAType id="{tid}">\n')
+            for n, bt, t in bdas:
+                w(f'      <BDA name="{n}" bType="{bt}"' + (f' type="{t}"' if t else '') + '/>\n')
+            w('    </DAType>\n')
+        for e in ("ctlModelKind", "SIUnitKind", "multiplierKind", "orCatKind"):
+            w(f'    <EnumType id="{e}"><EnumVal ord="0">a</EnumVal><EnumVal ord="1">b</EnumVal></EnumType>\n')
+        w('  </DataTypeTemplates>\n')
+
+    if args.templates_first:
+        templates()
+    for ied in range(args.ieds):
+        w(f'  <IED name="IED{ied}" manufacturer="synthetic">\n    <AccessPoint name="S1">\n      <Server>\n')
+        w('        <Authentication/>\n')
+        for ld in range(args.lds):
+            w(f'        <LDevice inst="LD{ld}">\n')
+            w(f'          <LN0 lnClass="LLN0" inst="" lnType="IED{ied}_LLN0">\n')
+            w('            <DataSet name="Events">\n')
+            for ln in range(min(args.lns, 8)):
+                cls = LN_CLASSES[ln % len(LN_CLASSES)][0]
+                w(f'              <FCDA ldInst="LD{ld}" lnClass="{cls}" lnInst="{ln + 1}" doName="Mod" daName="stVal" fc="ST"/>\n')
+            w('            </DataSet>\n')
+            w('            <DataSet name="Measurands">\n')
+            w(f'              <FCDA ldInst="LD{ld}" prefix="P" lnClass="MMXU" lnInst="2" doName="MV1" fc="MX"/>\n')
+            w('            </DataSet>\n')
+            w('            <ReportControl name="brcbEvents" datSet="Events" rptID="Events" confRev="1" buffered="true" bufTime="50" intgPd="1000">\n'
+              '              <TrgOps dchg="true" qchg="true" period="true" gi="true"/>\n'
+              '              <OptFields seqNum="true" timeStamp="true" dataSet="true" reasonCode="true" entryID="true" configRef="true"/>\n'
+              '              <RptEnabled max="5"/>\n            </ReportControl>\n')
+            w('            <ReportControl name="urcbMeas" datSet="Measurands" confRev="1" intgPd="2000">\n'
+              '              <TrgOps dchg="true" period="true"/>\n              <OptFields seqNum="true"/>\n              <RptEnabled max="2"/>\n            </ReportControl>\n')
+            w('          </LN0>\n')
+            for ln in range(args.lns):
+                cls = LN_CLASSES[ln % len(LN_CLASSES)][0]
+                prefix = ' prefix="P"' if ln == 1 else ''
+                w(f'          <LN{prefix} lnClass="{cls}" inst="{ln + 1}" lnType="IED{ied}_{cls}">\n')
+                w('            <DOI name="Mod"><DAI name="stVal"><Val>1</Val></DAI></DOI>\n')
+                w('          </LN>\n')
+            w('        </LDevice>\n')
+        w('      </Server>\n    </AccessPoint>\n  </IED>\n')
+    if not args.templates_first:
+        templates()
+    w('</SCL>\n')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,152 @@
+/*
+ * File: tools/mms_bench.c
+ * Author: Kiarash Mebadi <kiyarash.mebadi@gmail.com>
+ * Company: Azarakhsh Maham Shargh
+ * Description: MMS read latency and throughput benchmark against a running server (libiec61850 client).
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "iec61850_client.h"
+
+typedef struct {
+    const char* host;
+    int port;
+    const char* reference;
+    FunctionalConstraint fc;
+    int requests;
+    int gap_ms;
+    unsigned int seed;
+    double* latency;      // requests entries
+    int failed;
+    int connected;
+} BenchClient;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void* run_client(void* arg)
+{
+    BenchClient* client = arg;
+    IedClientError error;
+    IedConnection con = IedConnection_create();
+    IedConnection_connect(con, &error, client->host, client->port);
+    if (error != IED_ERROR_OK) {
+        fprintf(stderr, "❌ Cannot connect to %s:%d (error %d)\n", client->host, client->port, (int)error);
+        IedConnection_destroy(con);
+        return NULL;
+    }
+    client->connected = 1;
+
+    for (int i = 0; i < client->requests; ++i) {
+        if (client->gap_ms > 0)
+            usleep((useconds_t)(rand_r(&client->seed) % (client->gap_ms * 1000)));
+        double start = now_ms();
+        MmsValue* value = IedConnection_readObject(con, &error, client->reference, client->fc);
+        client->latency[i] = now_ms() - start;
+        if (error != IED_ERROR_OK || !value)
+            client->failed++;
+        if (value)
+            MmsValue_delete(value);
+    }
+
+    IedConnection_close(con);
+    IedConnection_destroy(con);
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 5) {
+        fprintf(stderr, "Usage: %s HOST PORT OBJECT_REFERENCE FC [--requests N] [--gap-ms MAX] [--clients N]\n",
+                argv[0]);
+        fprintf(stderr, "Example: %s 127.0.0.1 10102 IED_E01MAINLD0/LLN0.Mod.stVal ST\n", argv[0]);
+        return 1;
+    }
+
+    const char* host = argv[1];
+    int port = atoi(argv[2]);
+    const char* reference = argv[3];
+    FunctionalConstraint fc = FunctionalConstraint_fromString(argv[4]);
+    int requests = 1000;  // per client
+    int gap_ms = 20;      // random pause before each request, so requests land at any point of the server loop
+    int client_count = 1;
+    for (int argi = 5; argi < argc; ++argi) {
+        if (strcmp(argv[argi], "--requests") == 0 && argi + 1 < argc && atoi(argv[argi + 1]) > 0)
+            requests = atoi(argv[++argi]);
+        else if (strcmp(argv[argi], "--gap-ms") == 0 && argi + 1 < argc)
+            gap_ms = atoi(argv[++argi]);
+        else if (strcmp(argv[argi], "--clients") == 0 && argi + 1 < argc && atoi(argv[argi + 1]) > 0)
+            client_count = atoi(argv[++argi]);
+        else {
+            fprintf(stderr, "Unknown or invalid argument: %s\n", argv[argi]);
+            return 1;
+        }
+    }
+
+    BenchClient* clients = calloc((size_t)client_count, sizeof(BenchClient));
+    pthread_t* threads = calloc((size_t)client_count, sizeof(pthread_t));
+    double* latency = malloc((size_t)client_count * (size_t)requests * sizeof(double));
+    if (!clients || !threads || !latency) {
+        free(clients);
+        free(threads);
+        free(latency);
+        return 3;
+    }
+
+    // All connections read concurrently; the wall time gives the aggregate rate
+    double start = now_ms();
+    for (int c = 0; c < client_count; ++c) {
+        clients[c] = (BenchClient){ .host = host, .port = port, .reference = reference, .fc = fc,
+                                    .requests = requests, .gap_ms = gap_ms, .seed = (unsigned int)c + 1,
+                                    .latency = latency + (size_t)c * (size_t)requests };
+        if (pthread_create(&threads[c], NULL, run_client, &clients[c]) != 0) {
+            fprintf(stderr, "❌ Cannot start client thread %d\n", c);
+            client_count = c;
+            break;
+        }
+    }
+    int failed = 0;
+    size_t samples = 0;
+    for (int c = 0; c < client_count; ++c) {
+        pthread_join(threads[c], NULL);
+        if (!clients[c].connected) {
+            failed += requests;
+            continue;
+        }
+        // Keep the samples of connected clients contiguous
+        memmove(latency + samples, clients[c].latency, (size_t)requests * sizeof(double));
+        samples += (size_t)requests;
+        failed += clients[c].failed;
+    }
+    double elapsed = now_ms() - start;
+
+    if (samples > 0) {
+        qsort(latency, samples, sizeof(double), compare_double);
+        printf("%d client%s x %d reads of %s: %.0f reads/s, p50 %.3f ms, p99 %.3f ms, max %.3f ms, %d failed\n",
+               client_count, client_count == 1 ? "" : "s", requests, reference,
+               (double)samples * 1000.0 / elapsed, latency[samples / 2], latency[samples * 99 / 100],
+               latency[samples - 1], failed);
+    }
+
+    free(clients);
+    free(threads);
+    free(latency);
+    return samples == 0 ? 2 : (failed ? 4 : 0);
+}